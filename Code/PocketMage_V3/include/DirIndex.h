@@ -0,0 +1,58 @@
+#pragma once
+
+#include <Arduino.h>
+#include <SD_MMC.h>
+#include <vector>
+#include <stdint.h>
+
+// Cached recursive index of the SD card for the file pickers.
+// The card is walked once (skipping /sys and the excluded files) and kept in
+// memory; the SD write helpers update single entries as they go, so
+// listing, paging and sorting never touch the card again. invalidate()
+// forces a fresh walk, e.g. after the card was mounted over USB.
+// Paths live back to back in one pool (in PSRAM when there is some), and the
+// walk stops early rather than take the internal heap below
+// DIR_INDEX_MIN_FREE_HEAP.
+struct DirEntry {
+  uint32_t path;   // offset of the NUL-terminated path in the pool, no leading '/'
+  uint32_t size;
+  uint32_t mtime;
+};
+
+enum DirSort : uint8_t { SORT_NAME, SORT_DATE, SORT_SIZE };
+
+class DirIndex {
+public:
+  size_t  size();
+  String  path(size_t i);              // i-th path in the current sort order
+  String  find(const String& name);    // case-insensitive path or file name, "" if none
+
+  DirSort sortKey() const { return sortBy; }
+  void    setSort(DirSort key);
+  size_t  pageCount(size_t perPage);
+  // Fill out[0..perPage) with the paths on a page, "-" past the end
+  void    fillPage(size_t page, String* out, size_t perPage);
+
+  void    update(const String& path);  // re-stat a file or re-walk a directory after a write, rename or delete
+  void    invalidate();
+  void    warm() { ensure(); }          // scan and sort now, from the I/O worker
+
+private:
+  std::vector<DirEntry> entries;
+  std::vector<uint16_t> order;
+  char*   pool     = nullptr;
+  size_t  poolUsed = 0;
+  size_t  poolCap  = 0;
+  size_t  poolDead = 0;             // bytes of removed paths, reclaimed by repack()
+  bool    scanned = false;
+  bool    sorted  = false;
+  DirSort sortBy  = SORT_NAME;
+
+  void    ensure();
+  void    scan(const String& dir, uint8_t depth);
+  bool    indexable(const String& path) const;
+  const char* pathOf(const DirEntry& e) const { return pool + e.path; }
+  bool    add(const String& rel, uint32_t size, uint32_t mtime);
+  void    remove(size_t i);
+  void    repack();
+};
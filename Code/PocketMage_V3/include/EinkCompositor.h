@@ -0,0 +1,79 @@
+#pragma once
+
+#include <GxEPD2_BW.h>
+#include <stdint.h>
+#include "config.h"
+
+typedef GxEPD2_BW<GxEPD2_310_GDEQ031T10, GxEPD2_310_GDEQ031T10::HEIGHT> EinkPanel;
+
+struct EinkRect {
+  int16_t x, y, w, h;
+};
+
+#ifdef DESKTOP_EMULATOR
+// The emulator shim presents whole frames itself
+typedef EinkPanel EinkCompositor;
+#else
+// E-ink display with damage tracking.
+// Every pixel drawn is mirrored into a 1bpp copy of the frame, and a second
+// copy holds what the panel is currently showing. refresh() diffs the two to
+// find the rows that really changed, so a screen that is redrawn from scratch
+// but only differs in one line costs a partial refresh of that line.
+//
+// Ghosting is tracked per EINK_GHOST_TILE square tile, weighted by how many
+// pixels each refresh flipped there: partial refreshes add to partialGhost,
+// fast full refreshes fold it (and their own flips) into fullResidue, and a
+// slow full refresh clears both.
+class EinkCompositor : public EinkPanel {
+public:
+  EinkCompositor(const GxEPD2_310_GDEQ031T10& epd) : EinkPanel(epd) {}
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+  void fillScreen(uint16_t color) override;
+  void setRotation(uint8_t r) override;
+
+  // Same as GxEPD2_BW, but keep the panel copy in sync
+  void setFullWindow();
+  void setPartialWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+  void display(bool partial_update_mode = false);
+  void displayWindow(int16_t x, int16_t y, int16_t w, int16_t h);
+  bool nextPage();
+
+  // Bounding box of everything changed since the last panel update, byte
+  // aligned in x; empty (w = h = 0) when nothing changed
+  EinkRect damage();
+
+  // Worst tile's partial ghosting if the area r were partially refreshed now
+  uint32_t partialGhostWith(const EinkRect& r);
+  // Worst tile's residue left by fast full refreshes
+  uint32_t fullResidue() const;
+
+  bool inPartialWindow() const { return partialWindow; }
+  bool shownValid() const { return panelValid; }
+  void invalidateShown() { panelValid = false; }
+
+private:
+  static const size_t FRAME_BYTES = (GxEPD2_310_GDEQ031T10::WIDTH + 7) / 8 * GxEPD2_310_GDEQ031T10::HEIGHT;
+
+  uint8_t frame[FRAME_BYTES] = {0};   // what is drawn, 1 = black
+  uint8_t shown[FRAME_BYTES] = {0};   // what the panel shows
+  bool    panelValid = false;
+  bool    partialWindow = false;
+  EinkRect window = {0, 0, 0, 0};
+
+  static const int GHOST_TILES = (GxEPD2_310_GDEQ031T10::HEIGHT + EINK_GHOST_TILE - 1) / EINK_GHOST_TILE;
+  struct GhostTile {
+    uint32_t partialGhost;
+    uint32_t residue;
+  };
+  GhostTile ghost[GHOST_TILES][GHOST_TILES] = {};
+  uint16_t  flips[GHOST_TILES][GHOST_TILES];
+
+  void countFlips(int16_t x, int16_t y, int16_t w, int16_t h);
+  void recordPartial(int16_t x, int16_t y, int16_t w, int16_t h);
+  void recordFull();
+
+  int  stride() const { return (width() + 7) / 8; }
+  void markShown(int16_t x, int16_t y, int16_t w, int16_t h);
+};
+#endif
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "globals.h"
+
+// Per-font glyph advance table.
+// Built once from the GFXfont glyph data the first time a font is measured, so
+// line widths can be summed per character instead of calling getTextBounds on
+// the whole line. Monospace fonts skip the table entirely.
+struct GlyphAdvance {
+  const GFXfont* font = nullptr;
+  uint8_t first = 0;
+  uint8_t last  = 0;
+  uint8_t advance[256] = {0};
+  uint8_t fallback = 0;     // used for bytes outside the font (UTF-8 characters)
+  bool    mono = false;
+  uint8_t monoAdvance = 0;
+
+  // Width of the character whose lead byte is c (continuation bytes add nothing)
+  uint8_t charWidth(char c) const {
+    uint8_t b = (uint8_t)c;
+    if ((b & 0xC0) == 0x80) return 0;
+    if (mono) return monoAdvance;
+    return (b >= first && b <= last) ? advance[b] : fallback;
+  }
+
+  uint16_t measure(const String& s, size_t from, size_t to) const {
+    uint16_t w = 0;
+    for (size_t i = from; i < to; i++) w += charWidth(s[i]);
+    return w;
+  }
+
+  uint16_t measure(const String& s) const { return measure(s, 0, s.length()); }
+};
+
+inline const GlyphAdvance& glyphAdvance(const GFXfont* font) {
+  static GlyphAdvance cache[8];
+  static uint8_t next = 0;
+
+  for (auto& t : cache) {
+    if (t.font == font) return t;
+  }
+
+  GlyphAdvance& t = cache[next];
+  next = (next + 1) % 8;
+  t = GlyphAdvance();
+  t.font  = font;
+  t.first = font->first;
+  t.last  = font->last;
+
+#ifdef DESKTOP_EMULATOR
+  // Emulator fonts carry no glyph data, match its getTextBounds (6px/char)
+  t.mono = true;
+  t.monoAdvance = 6;
+  t.fallback = 6;
+#else
+  for (uint16_t c = t.first; c <= t.last; c++) {
+    t.advance[c] = font->glyph[c - t.first].xAdvance;
+  }
+  t.fallback = (t.first <= '?' && '?' <= t.last) ? t.advance['?'] : t.advance[t.first];
+
+  // MONOSPACE CHECK
+  t.mono = true;
+  for (uint16_t c = t.first; c <= t.last; c++) {
+    if (t.advance[c] != t.advance[t.first]) {
+      t.mono = false;
+      break;
+    }
+  }
+  t.monoAdvance = t.advance[t.first];
+#endif
+
+  return t;
+}
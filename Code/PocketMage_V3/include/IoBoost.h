@@ -0,0 +1,35 @@
+#pragma once
+
+#include <atomic>
+#include "IoWorker.h"
+
+// Keeps the CPU at full speed while SD work is in flight.
+// Sessions nest and may overlap across tasks: the first one raises the clock
+// and marks SDActive, and once the last one ends the clock stays up for
+// IO_BOOST_IDLE_MS so a burst of file operations pays for one clock change.
+// IoBoostSession::idle() is polled from loop() to drop back to POWER_SAVE_FREQ.
+// Each session also holds the SD bus lock for its lifetime. Code that sets the
+// clock outside a session goes through boost() and release(), so the sessions
+// always know whether the clock is up. pin() holds full speed across loop()
+// passes, e.g. for a whole USB mass storage session, until unpin().
+class IoBoostSession {
+public:
+  IoBoostSession();
+  ~IoBoostSession();
+  IoBoostSession(const IoBoostSession&) = delete;
+  IoBoostSession& operator=(const IoBoostSession&) = delete;
+
+  static void idle();
+  static void boost();    // full speed now, idle() lowers it again later
+  static void release();  // back to POWER_SAVE_FREQ now, unless a session is open
+  static void pin();      // full speed until unpin(), idle() and release() leave it up
+  static void unpin();
+
+private:
+  SdBusLock bus;
+
+  static std::atomic<int>  depth;
+  static std::atomic<int>  pinned;
+  static std::atomic<bool> boosted;
+  static volatile unsigned long releasedAt;
+};
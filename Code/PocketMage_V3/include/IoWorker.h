@@ -0,0 +1,51 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Background SD work, off the UI loop.
+// Jobs run in submission order on a low-priority task on core 0 and must not
+// touch the OLED, keypad or e-ink; their completion callbacks run later on
+// loop() from poll(), where it is safe to report back. Any SD access from
+// another task (through SdBusLock, which every IoBoostSession holds) first
+// waits for queued jobs, so a read always sees an earlier background save.
+class IoWorker {
+public:
+  using Job  = std::function<bool()>;        // runs on the I/O task, true on success
+  using Done = std::function<void(bool ok)>; // runs on loop()
+
+  void begin();
+  bool submit(Job job, Done done = nullptr);
+  void poll();                   // loop(): run callbacks of finished jobs
+  void drain();                  // wait until every queued job has run
+  bool busy() const { return outstanding.load() > 0; }
+  bool onWorker() const;
+
+private:
+  struct Request {
+    Job  job;
+    Done done;
+    bool ok;
+  };
+  std::atomic<int> outstanding{0};
+  std::mutex            doneLock;   // finished requests waiting for poll(), unbounded
+  std::vector<Request*> doneList;   // so the worker never blocks on loop()
+
+  static void task(void* param);
+  void finish(Request* req);
+};
+
+// Serializes SD access between tasks. Recursive, and waits for queued
+// background jobs unless taken on the worker or already held by this task.
+class SdBusLock {
+public:
+  SdBusLock();
+  ~SdBusLock();
+  SdBusLock(const SdBusLock&) = delete;
+  SdBusLock& operator=(const SdBusLock&) = delete;
+};
+
+extern IoWorker ioWorker;
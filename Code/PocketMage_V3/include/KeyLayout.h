@@ -0,0 +1,82 @@
+#pragma once
+
+#include <Arduino.h>
+#include <SD_MMC.h>
+#include <vector>
+#include <stdint.h>
+
+// Compiled keyboard layout ("KBL1").
+// The JSON layouts in /sys/kbd/ are compiled once into /sys/kbd/<name>.kbl,
+// which is tagged with the size and mtime of its JSON source so edits trigger
+// a rebuild. Switching layouts is then a single read of that file, and the
+// key cells and dead-key rules are used straight from the loaded blob:
+//   header | key cells [3 layers][4][10] | bucket displacements | rule slots | string pool
+// Dead-key rules sit in a perfect hash (hash and displace) keyed by the
+// accent and base codepoints, so composing is one probe with no allocation.
+// Multi-byte fields are stored little-endian, native on the ESP32 and desktop.
+class CompiledLayout {
+public:
+  bool        adopt(std::vector<uint8_t>& data);  // takes the buffer's contents
+  // Loads path if it was compiled from a source of this size and mtime
+  bool        loadFile(const char* path, uint32_t srcSize, uint32_t srcMtime);
+  bool        valid() const { return header != nullptr; }
+
+  const char* name() const;
+  uint8_t     action(uint8_t layer, uint8_t row, uint8_t col) const;  // a KeyAction
+  const char* text(uint8_t layer, uint8_t row, uint8_t col) const;
+  // Composed UTF-8 for accent + base, nullptr if the layout has no such rule
+  const char* compose(const char* accent, const char* base) const;
+
+  struct Header {
+    char     magic[4];
+    uint32_t srcSize;
+    uint32_t srcMtime;
+    uint16_t buckets;
+    uint16_t slots;
+    uint16_t poolSize;
+    uint16_t nameOffset;
+  };
+  struct Cell {
+    uint8_t  action;
+    uint8_t  length;
+    uint16_t offset;   // into the string pool
+  };
+  struct Slot {
+    uint32_t accent;   // 0 = empty
+    uint32_t base;
+    uint16_t offset;
+    uint16_t length;
+  };
+
+private:
+  std::vector<uint8_t> blob;
+  const Header*   header = nullptr;
+  const Cell*     cells = nullptr;
+  const uint16_t* disp = nullptr;
+  const Slot*     slots = nullptr;
+  const char*     pool = nullptr;
+};
+
+// Collects a layout from any source (JSON, the built-in fallback) and emits
+// the blob CompiledLayout loads
+class KeyLayoutBuilder {
+public:
+  void setName(const String& name) { layoutName = name; }
+  void setKey(uint8_t layer, uint8_t row, uint8_t col, uint8_t action, const String& text);
+  bool addDead(const String& accent, const String& base, const String& out);  // single codepoints only
+  std::vector<uint8_t> build(uint32_t srcSize, uint32_t srcMtime) const;
+
+private:
+  struct Key {
+    uint8_t action = 0;
+    String  text;
+  };
+  struct Rule {
+    uint32_t accent;
+    uint32_t base;
+    String   out;
+  };
+  String            layoutName;
+  Key               keys[3][4][10];
+  std::vector<Rule> rules;
+};
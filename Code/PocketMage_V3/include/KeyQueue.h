@@ -0,0 +1,36 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <stdint.h>
+
+// Lossless keypad input.
+// The TCA8418 only holds 10 events, so reading one per loop() pass drops
+// keys under fast typing. The keypad interrupt wakes a small task that reads
+// the whole FIFO into this ring straight away, and the apps take the keys
+// from here at their own pace, several per pass if they like. Single
+// producer (the drain task) and single consumer (loop()), so no locking.
+// Without the task (before begin(), or in the emulator) pop() drains on
+// demand instead. Entries are the chip's raw event bytes: bit 7 set on
+// press, low bits the 1-based key number.
+class KeyQueue {
+public:
+  void begin();
+  void isr();                 // from the keypad interrupt
+  void drain();               // move the chip's FIFO into the ring
+
+  bool     pop(uint8_t& code);
+  size_t   pending() const;
+  void     clear();           // drop queued keys, e.g. after waking
+  uint32_t dropped() const { return lost.load(); }
+
+private:
+  uint8_t               ring[KB_QUEUE_LEN];
+  std::atomic<uint16_t> head{0};   // written by the producer
+  std::atomic<uint16_t> tail{0};   // written by the consumer
+  std::atomic<uint32_t> lost{0};
+
+  static void task(void* param);
+};
+
+extern KeyQueue keyQueue;
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <Arduino.h>
+#include <mutex>
+#include <stdint.h>
+
+// Raw sector access for USB mass storage. The device backs this with the
+// SDMMC driver, the desktop emulator with a disk image file.
+class BlockDevice {
+public:
+  virtual ~BlockDevice() {}
+  virtual uint32_t sectorSize() = 0;
+  virtual uint32_t sectorCount() = 0;
+  virtual bool     readSectors(uint8_t* dst, uint32_t lba, uint32_t count) = 0;
+  virtual bool     writeSectors(const uint8_t* src, uint32_t lba, uint32_t count) = 0;
+  // Transfer buffers, DMA capable where the driver needs it
+  virtual uint8_t* allocBuffer(size_t bytes) { return (uint8_t*)malloc(bytes); }
+  virtual void     freeBuffer(uint8_t* buf)  { free(buf); }
+};
+
+// Sits between the MSC callbacks and the card.
+// Host requests go to the card as one multi-sector transfer instead of one
+// command per sector. A sequential read fills MSC_READ_AHEAD_SECTORS at once
+// and the following requests are served from it; contiguous writes collect
+// in MSC_WRITE_COALESCE_SECTORS and go out together once the run breaks, the
+// buffer fills, the data is read back, or the host goes quiet for
+// MSC_FLUSH_MS. Called from the USB task and loop(), so every entry locks.
+// A deferred write that fails stays buffered and is retried, and the next
+// host request fails so the host learns its earlier write did not land.
+class MscCache {
+public:
+  bool begin(BlockDevice* device);
+  void end();
+
+  int32_t read(uint32_t lba, uint8_t* dst, uint32_t bytes);
+  int32_t write(uint32_t lba, const uint8_t* src, uint32_t bytes);
+
+  bool flush();   // write out coalesced sectors
+  void idle();    // polled from the USB app loop
+
+private:
+  BlockDevice* dev = nullptr;
+  std::mutex   lock;
+  uint32_t     secSize = 0;
+
+  uint8_t*     ahead = nullptr;       // read-ahead window
+  uint32_t     aheadLba = 0;
+  uint32_t     aheadCount = 0;
+  uint32_t     nextReadLba = UINT32_MAX;
+
+  uint8_t*     pending = nullptr;     // coalesced writes
+  uint32_t     pendingLba = 0;
+  uint32_t     pendingCount = 0;
+  unsigned long lastWrite = 0;
+  bool         writeFailed = false;   // deferred write lost, report it next request
+
+  bool flushLocked();
+  void releaseLocked();
+};
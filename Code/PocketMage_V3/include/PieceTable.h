@@ -0,0 +1,69 @@
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+
+// Piece table text buffer for the TXT editor.
+// The loaded file lives untouched in the original buffer and everything typed
+// is appended to the add buffer; the document is the ordered list of pieces
+// pointing into those two. Pieces sit in a treap in document order, each node
+// holding the byte length of its subtree, so a piece's offset is summed on the
+// way down and no edit has to touch the pieces after it: lookups, inserts and
+// erases are O(log pieces). Consecutive typing just grows the last piece.
+class PieceTable {
+public:
+  void   load(const String& text);
+  void   clear();
+  void   insert(size_t pos, const String& text);
+  void   erase(size_t pos, size_t len);
+
+  size_t length() const { return totalLength; }
+  char   charAt(size_t pos) const;
+  String substring(size_t start, size_t end) const;
+  String toString() const { return substring(0, totalLength); }
+
+  // Hard line helpers ('\n' delimited)
+  size_t lineStart(size_t pos) const;  // first offset of the line holding pos
+  size_t lineEnd(size_t pos) const;    // offset of its '\n', or length()
+
+  // UTF-8 aware cursor steps
+  size_t prevChar(size_t pos) const;
+  size_t nextChar(size_t pos) const;
+
+private:
+  struct Piece {
+    bool     added;   // false = original buffer, true = add buffer
+    uint32_t start;   // offset into its buffer
+    uint32_t len;     // bytes
+  };
+  struct Node {
+    Piece    piece;
+    uint32_t sum;     // bytes in this subtree
+    uint32_t prio;
+    int32_t  left;
+    int32_t  right;
+  };
+
+  String original;
+  String addBuf;
+  std::vector<Node>    nodes;
+  std::vector<int32_t> freeNodes;
+  int32_t  root = -1;
+  size_t   totalLength = 0;
+  uint32_t seed = 0x9E3779B9;
+
+  const char* bufferOf(const Piece& p) const { return p.added ? addBuf.c_str() : original.c_str(); }
+  uint32_t sumOf(int32_t t) const { return t < 0 ? 0 : nodes[t].sum; }
+  int32_t  newNode(const Piece& p);
+  void     freeTree(int32_t t);
+  void     pull(int32_t t);
+  void     split(int32_t t, size_t pos, int32_t& l, int32_t& r);
+  int32_t  merge(int32_t a, int32_t b);
+  int32_t  locate(size_t pos, size_t& pieceStart) const;
+
+  void   collect(int32_t t, size_t base, size_t from, size_t to, String& out) const;
+  size_t findNewline(int32_t t, size_t base, size_t from) const;
+  size_t findNewlineBefore(int32_t t, size_t base, size_t before) const;
+};
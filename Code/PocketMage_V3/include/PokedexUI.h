@@ -88,10 +88,12 @@ public:
 // Sprite Cache
 class SpriteCache {
 private:
+  // Sprites are kept decoded as 1bpp (0 bit = black) and expanded to the 4bpp
+  // drawSprite format on the way out
   struct CacheEntry {
     uint16_t id;
-    uint8_t* data64;  // 64x64 sprite
-    uint8_t* data32;  // 32x32 downscaled
+    uint8_t data64[64 * 64 / 8];  // 64x64 sprite
+    uint8_t data32[32 * 32 / 8];  // 32x32 downscaled
     bool valid;
     int lastUsed;
   };
@@ -99,20 +101,32 @@ private:
   std::vector<CacheEntry> cache;
   int maxEntries;
   int accessCounter;
+  std::vector<uint16_t> prefetchQueue;
+  uint8_t out64[64 * 64 / 2];
+  uint8_t out32[32 * 32 / 2];
   
 public:
   SpriteCache(int maxEntries = 24);
   ~SpriteCache();
   
+  // Returned buffers are 4bpp and stay valid until the next get of the same size
   const uint8_t* get64(uint16_t id);
   const uint8_t* get32(uint16_t id);
   void preload(uint16_t id);
   void setLoader(bool (*loader)(uint16_t id, uint8_t* out, int stride, int w, int h));
   
+  // Idle-time prefetch: queue ids, then load one per prefetchStep() call
+  void queuePrefetch(uint16_t id);
+  void clearPrefetch() { prefetchQueue.clear(); }
+  bool prefetchStep();
+  
 private:
   bool (*spriteLoader)(uint16_t id, uint8_t* out, int stride, int w, int h) = nullptr;
-  void evictLRU();
+  CacheEntry* find(uint16_t id);
+  CacheEntry* load(uint16_t id);
+  CacheEntry& evictLRU();
   void downscale64to32(const uint8_t* src, uint8_t* dst);
+  static void expand4bpp(const uint8_t* src, int size, uint8_t* dst);
 };
 
 // Search and Filter Model
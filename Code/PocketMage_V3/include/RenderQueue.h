@@ -0,0 +1,62 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <stdint.h>
+
+// Render requests from loop() (core 1) to the einkHandler task (core 0).
+// Pending requests are bits in a single atomic word, so posting the same
+// request twice before the task gets to it coalesces into one redraw. Every
+// post notifies the task, which otherwise sleeps instead of polling.
+enum RenderBit : uint32_t {
+  RENDER_STATE  = 1u << 0,  // newState
+  RENDER_LINE   = 1u << 1,  // newLineAdded
+  RENDER_FULL   = 1u << 2,  // doFull
+  RENDER_CURSOR = 1u << 3,  // cursorMoved
+  RENDER_RETRY  = 1u << 4,  // handler wants another pass soon, no notification
+};
+
+class RenderQueue {
+public:
+  explicit RenderQueue(uint32_t initial = 0) : pending(initial) {}
+
+  void attach(TaskHandle_t task) { consumer = task; }
+
+  void post(uint32_t bits);
+  void clear(uint32_t bits) { pending.fetch_and(~bits, std::memory_order_acq_rel); }
+  bool test(uint32_t bits) const { return pending.load(std::memory_order_acquire) & bits; }
+
+  // Atomically clears and returns the requested bits that were pending
+  uint32_t take(uint32_t bits) { return pending.fetch_and(~bits, std::memory_order_acq_rel) & bits; }
+
+  // Ask for another handler pass after EINK_RETRY_MS without waking the task now
+  void retryLater() { pending.fetch_or(RENDER_RETRY, std::memory_order_release); }
+
+  // Sleeps until the next post or timeoutMs, whichever is first
+  void wait(uint32_t timeoutMs);
+
+private:
+  std::atomic<uint32_t> pending;
+  TaskHandle_t consumer = nullptr;
+};
+
+extern RenderQueue renderQueue;
+
+// Stands in for the old volatile bool flags, so "newState = true" posts a
+// request. Handlers consume it with take(), which reads and clears in one
+// step so a request posted mid-check is never lost; pending() only peeks.
+class RenderFlag {
+public:
+  explicit RenderFlag(uint32_t bit) : bit(bit) {}
+
+  RenderFlag& operator=(bool set) {
+    if (set) renderQueue.post(bit);
+    else     renderQueue.clear(bit);
+    return *this;
+  }
+  bool take()          { return renderQueue.take(bit); }
+  bool pending() const { return renderQueue.test(bit); }
+
+private:
+  const uint32_t bit;
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+#include <stdint.h>
+
+// Document offset of each wrapped TXT row.
+// Rows are stored as the gap from the previous row's start in a Fenwick tree,
+// so a row's start is a prefix sum and everything below an edit moves with it
+// for free: an edit that keeps the row count updates only the rows it
+// re-wrapped, O(rows touched * log rows). Adding or removing rows rebuilds the
+// tree in O(rows), which is also what splicing allLines costs.
+class RowIndex {
+public:
+  void     assign(const std::vector<uint32_t>& starts);
+  void     clear() { gaps.clear(); tree.clear(); }
+  size_t   size() const  { return gaps.size(); }
+  bool     empty() const { return gaps.empty(); }
+
+  uint32_t operator[](size_t row) const;       // start of row
+  size_t   countAtOrBefore(uint32_t pos) const; // rows starting at or before pos
+  size_t   countBefore(uint32_t pos) const;     // rows starting before pos
+
+  // Replace rows [first, last) with rows starting at starts, and move every
+  // later row by delta bytes
+  void     replace(size_t first, size_t last, const std::vector<uint32_t>& starts, long delta);
+
+private:
+  std::vector<uint32_t> gaps;  // start[r] - start[r - 1], gaps[0] = start[0]
+  std::vector<uint32_t> tree;  // Fenwick sums over gaps, 1-based
+
+  void     build();
+  void     add(size_t row, long delta);
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <Arduino.h>
+#include <SD_MMC.h>
+#include <stdint.h>
+
+// Write-back buffer for small appends to SD files.
+// Record files (tasks, events, the metadata log) are rewritten one line at a
+// time; each line used to be its own open/append/close. Appends are now kept
+// in a few per-path buffers (PSRAM when present) and written out in one go
+// when a buffer fills, the file is read, replaced or renamed, the device
+// sleeps or USB mode takes the card, or nothing was appended for SD_CACHE_IDLE_MS.
+class SdCache {
+public:
+  // Queue bytes for the end of path. False means the caller must write them
+  // itself (too large or no buffer); anything queued before is flushed first.
+  bool append(const String& path, const char* data, size_t len);
+
+  void flush(const String& path);     // before path is read or renamed
+  void discard(const String& path);   // path is being overwritten or removed
+  void flushAll();                    // save, sleep and USB mode
+  void idle();                        // polled from loop()
+
+private:
+  struct Slot {
+    String        path;
+    char*         buf = nullptr;
+    size_t        used = 0;
+    unsigned long lastAppend = 0;
+  };
+  Slot slots[SD_CACHE_SLOTS];
+
+  Slot* find(const String& path);
+  Slot* claim(const String& path);
+  void  writeOut(Slot& s);
+};
+
+// Sequential line reader with SD_READ_AHEAD bytes of read-ahead, replacing
+// per-byte File::readStringUntil() when parsing record files.
+class SdLineReader {
+public:
+  explicit SdLineReader(File& file);
+  ~SdLineReader();
+  SdLineReader(const SdLineReader&) = delete;
+  SdLineReader& operator=(const SdLineReader&) = delete;
+
+  // Next line without its '\n', false at the end of the file
+  bool readLine(String& line);
+
+private:
+  File&  file;
+  char*  buf;
+  size_t pos = 0;
+  size_t len = 0;
+  bool   eof = false;
+
+  bool   fill();
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <Arduino.h>
+#include <SD_MMC.h>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include <stdint.h>
+
+// Read-only paged viewer for text files too large for the TXT editor.
+// The file is never loaded whole: a sidecar index in /sys/view/ stores the
+// byte offset of every line, and only the wrapped rows of the lines around
+// the viewport are kept in memory. Lines longer than TXT_VIEW_MAX_LINE bytes
+// are split in the index, so one huge line can't blow the window either.
+// loop() opens and scrolls the viewer while the e-ink task draws it, so every
+// public call holds the viewer's lock.
+class TextViewer {
+public:
+  bool     open(const String& path);
+  void     close();
+  bool     isOpen() const;
+
+  // Move the viewport by rows (positive = towards the end), keeping viewRows filled
+  void     scroll(long rows, long viewRows);
+  // The rows currently on screen, at most viewRows of them
+  void     visibleRows(std::vector<String>& out, long viewRows) const;
+
+  uint32_t lineCount() const;
+  uint32_t topLine() const;
+  String   path() const;
+
+private:
+  struct Row {
+    String   text;
+    uint32_t line;  // index entry the row was wrapped from
+  };
+
+  mutable std::mutex lock;
+  String   filePath;
+  String   indexPath;
+  File     file;
+  File     index;
+  bool     opened = false;
+  uint32_t fileSize = 0;
+  uint32_t count = 0;
+
+  std::deque<Row> window;   // wrapped rows of lines [winFirst, winEnd)
+  uint32_t winFirst = 0;
+  uint32_t winEnd = 0;
+  long     top = 0;         // window row at the top of the viewport
+
+  void     closeLocked();
+  bool     indexIsCurrent();
+  bool     buildIndex();
+  uint32_t lineOffset(uint32_t line);
+  String   readLine(uint32_t line);
+  void     wrapLine(uint32_t line, std::vector<Row>& rows);
+  void     pushFront();
+  void     pushBack();
+  void     trim(long viewRows);
+};
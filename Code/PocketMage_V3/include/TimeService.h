@@ -0,0 +1,35 @@
+#pragma once
+
+#include <Arduino.h>
+#include <mutex>
+#include <stdint.h>
+#include "RTClib.h"
+
+// Wall clock for the UI.
+// Reading the PCF8563 is an I2C transaction, and the status bar and apps
+// want the time on every frame. The RTC is read once and the time then runs
+// on from millis(), re-reading it every TIME_RESYNC_MS, after waking and
+// whenever the clock is set. minuteChanged()/secondChanged() tell a view
+// whether what it shows is out of date, so it only redraws when it is.
+class TimeService {
+public:
+  void     sync();                    // re-read the RTC now
+  void     set(const DateTime& t);    // adjust the RTC and follow it
+  DateTime now();
+  uint32_t unixtime();
+
+  // True when the current minute/second differs from seen, which is then
+  // updated; start seen at UINT32_MAX to get the first one
+  bool     minuteChanged(uint32_t& seen);
+  bool     secondChanged(uint32_t& seen);
+
+private:
+  std::mutex    lock;   // the e-ink task reads the clock as well
+  uint32_t      baseUnix = 0;
+  unsigned long baseMillis = 0;
+  bool          synced = false;
+
+  void     syncLocked();
+};
+
+extern TimeService timeService;
@@ -4,21 +4,68 @@
 // CONFIGURATION & SETTINGS
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////|
 #define KB_COOLDOWN 50                          // Keypress cooldown
+#define KB_QUEUE_LEN 64                         // Keypad events buffered between passes (power of 2)
+#define KB_BATCH_MAX 16                         // Queued keys the editor applies per pass
+#define KB_DRAIN_STACK 3072                     // Keypad drain task stack (bytes)
+#define KB_DRAIN_POLL_MS 250                    // Drain task checks the FIFO this often without an interrupt
+#define KB_KEY_LEFT 19                          // Bottom-row arrow and select keys (keysArray codes)
+#define KB_KEY_SELECT 20
+#define KB_KEY_RIGHT 21
 #define FULL_REFRESH_AFTER 5                    // Full refresh after N partial refreshes (CHANGE WITH CAUTION)
+#define EINK_GHOST_TILE 32                      // Ghosting is tracked per square tile of this size (px)
+#define EINK_GHOST_PARTIAL_BUDGET 2048          // Flipped px a tile takes in partial refreshes before a fast full
+#define EINK_GHOST_FAST_DIVISOR 4               // Fast full residue per flipped px (1/N)
+#define EINK_GHOST_CARRY_DIVISOR 4              // Partial ghosting a fast full leaves as residue (1/N)
+#define EINK_GHOST_SLOW_BUDGET 1024             // Tile residue from fast fulls before a slow full
+#define EINK_PARTIAL_MAX_AREA 50                // Damage above this % of the screen gets a fast full refresh
 #define MAX_FILES 10                            // Number of files to store
+#define DIR_INDEX_MAX_ENTRIES 4000              // Files kept in the SD directory index
+#define DIR_INDEX_MAX_DEPTH 4                   // Subdirectory levels walked by the directory index
+#define DIR_INDEX_MIN_FREE_HEAP 49152           // Internal heap the directory index always leaves free (bytes)
+#define DIR_INDEX_POOL_CHUNK 4096               // Directory index path pool grows from this size (bytes)
 #define FORMAT_SPIFFS_IF_FAILED true            // Format the SPIFFS filesystem if mount fails
 #define SLEEPMODE "TEXT"                        // TEXT, SPLASH, CLOCK
 #define TXT_APP_STYLE 1                         // 0: Old Style (NOT SUPPORTED), 1: New Style
 #define SET_CLOCK_ON_UPLOAD false               // Should system clock be set automatically on code upload?
+#define TIME_RESYNC_MS 600000                   // Cached clock re-reads the RTC this often (ms)
 #define TOUCH_TIMEOUT_MS 1200                   // Delay after scrolling to return to typing mode (ms)
+#define TOUCH_IDLE_POLL_MS 200                  // Slider read interval while untouched, without TOUCH_IRQ (ms)
+#define TOUCH_FRAME_MS 80                       // Slider scroll is applied at most this often (ms)
+#define TOUCH_FLING_MIN 6                       // Pads/s at lift-off that keep the slider scrolling
+#define TOUCH_COAST_MS 300                      // Time constant of the inertial scroll slowing down (ms)
+#define TXT_VIEW_THRESHOLD 65536                // Files larger than this open in the read-only viewer (bytes)
+#define TXT_VIEW_MAX_LINE 2048                  // Viewer index splits lines longer than this (bytes)
+#define TXT_VIEW_DIR "/sys/view"                // Viewer line-offset sidecar indexes
+#define FILE_IO_CHUNK 1024                      // Block size for bulk SD reads and writes (bytes)
+#define FILE_COPY_CHUNK 4096                    // Buffer for streaming file copies (bytes)
+#define SD_CACHE_SLOTS 4                        // Files with appends buffered at once
+#define SD_CACHE_SIZE 4096                      // Buffered append bytes per file before writing out
+#define SD_CACHE_IDLE_MS 5000                   // Buffered appends are written out after this long untouched
+#define SD_READ_AHEAD 4096                      // Read-ahead block for line-by-line record parsing (bytes)
+#define MSC_READ_AHEAD_SECTORS 32               // USB mass storage read-ahead window (sectors)
+#define MSC_WRITE_COALESCE_SECTORS 32           // Contiguous USB writes gathered into one card command (sectors)
+#define MSC_FLUSH_MS 250                        // Gathered USB writes go out after this long without a write
 #define SYS_METADATA_FILE "/sys/SDMMC_META.txt" // File path to the file system metadata file
+#define META_COMPACT_SLACK 32                   // Dead metadata records tolerated beyond the live count
+#define SYS_TASKS_FILE "/sys/tasks.txt"         // Task records
+#define TASK_COMPACT_SLACK 16                   // Deleted task records tolerated beyond the live count
+#define JOURNAL_INDEX_FILE "/sys/journal.idx"   // Per-year journal presence bitmaps
 #define POWER_SAVE_FREQ 40                      // CPU freq for power save mode
+#define IO_BOOST_IDLE_MS 2000                   // Clock stays at 240MHz this long after the last SD operation
+#define IO_QUEUE_LEN 8                          // Background SD jobs queued before submit() runs them inline
+#define IO_WORKER_STACK 8192                    // I/O worker task stack (bytes)
+#define EINK_IDLE_WAKE_MS 1000                  // E-ink task sleeps this long when nothing is requested
+#define EINK_RETRY_MS 50                        // Re-poll delay when a handler asks to run again
+#define POKEDEX_PREFETCH_RADIUS 6               // Sprites prefetched either side of the dex selection
+#define OLED_WIDTH_CACHE 32                     // OLED string widths remembered across frames
+#define OLED_TILE_MERGE_GAP 2                   // Clean tiles between two changed runs sent along to join them
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////|
 
 // PIN DEFINITION
 #define I2C_SCL       35
 #define I2C_SDA       36
 #define MPR121_ADDR   0x5A
+#define TOUCH_IRQ     -1  // MPR121 IRQ pin, -1 polls the slider instead
 
 #define KB_IRQ        8
 #define PWR_BTN       38
@@ -41,5 +88,8 @@
 #define SD_CLK        12
 #define SD_CMD        11
 #define SD_D0         13
+#define SD_D1         -1  // Set D1-D3 to run the card 4-bit, -1 keeps the 1-bit wiring
+#define SD_D2         -1
+#define SD_D3         -1
 
 #endif
\ No newline at end of file
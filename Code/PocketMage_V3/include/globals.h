@@ -25,6 +25,18 @@
 
 #include "assets.h"
 #include "config.h"
+#include "PieceTable.h"
+#include "RowIndex.h"
+#include "RenderQueue.h"
+#include "EinkCompositor.h"
+#include "TextViewer.h"
+#include "IoBoost.h"
+#include "DirIndex.h"
+#include "SdCache.h"
+#include "MscCache.h"
+#include "KeyLayout.h"
+#include "KeyQueue.h"
+#include "TimeService.h"
 
 // FONTS
 // 3x7
@@ -50,7 +62,7 @@
 //u8g2_font_courR08_tf.h
 
 // Display
-extern GxEPD2_BW<GxEPD2_310_GDEQ031T10, GxEPD2_310_GDEQ031T10::HEIGHT> display;
+extern EinkCompositor display;
 extern U8G2_SSD1326_ER_256X32_F_4W_HW_SPI u8g2;           // 256x32 SPI OLED
 
 // Keypad
@@ -67,6 +79,7 @@ extern Adafruit_MPR121 cap;
 
 // RTC
 extern RTC_PCF8563 rtc;
+extern TimeService timeService;
 extern const char daysOfTheWeek[7][12];
 
 // USB
@@ -74,6 +87,7 @@ extern const char daysOfTheWeek[7][12];
 extern USBMSC msc;
 extern bool mscEnabled;
 extern sdmmc_card_t* card;
+extern MscCache mscCache;
 
 // GENERAL
 
@@ -95,17 +109,20 @@ extern int KBBounceMillis;
 extern volatile int timeoutMillis;
 extern volatile int prevTimeMillis;
 extern volatile bool TCA8418_event;
+extern KeyQueue keyQueue;
 extern volatile bool PWR_BTN_event;
+extern volatile bool MPR121_event;
 extern volatile bool SHFT;
 extern volatile bool FN;
-extern volatile bool newState;
+extern RenderQueue renderQueue;
+extern RenderFlag newState;
 extern bool noTimeout;
 extern volatile bool OLEDPowerSave;
 extern volatile bool disableTimeout;
 extern volatile int battState;
 extern volatile int prevBattState;
 extern unsigned int flashMillis;
-extern int prevTime;
+extern uint32_t prevTime;
 extern uint8_t prevSec;
 extern TaskHandle_t einkHandlerTaskHandle;
 extern char currentKB[4][10];
@@ -173,20 +190,13 @@ struct KeyboardLayout {
   std::map<String, std::map<String, String>> deadKeys;
 };
 
-// Dead-key composition rule
-struct DeadRule {
-  String accent;  // e.g., "´"
-  String base;    // e.g., "a"
-  String out;     // e.g., "á"
-};
-
-// Active keyboard layout and composition table
+// Active keyboard layout; key lookups and dead-key composition use the
+// compiled form
 extern KeyboardLayout CurrentLayout;
-extern std::vector<DeadRule> DeadTable;
+extern CompiledLayout ActiveLayout;
 extern String CurrentDead;         // empty if none
 extern String CurrentLayoutName;   // persisted in Preferences
 
-extern uint8_t partialCounter;
 extern volatile bool forceSlowFullUpdate;
 
 enum AppState { HOME, TXT, FILEWIZ, USB_APP, BT, SETTINGS, TASKS, CALENDAR, JOURNAL, LEXICON, POKEDEX, PERIODIC };
@@ -206,6 +216,11 @@ extern String outLines[13];
 extern String lines_prev[13];
 extern String filesList[MAX_FILES];
 extern uint8_t fileIndex;
+extern uint16_t filesPage;                 // page of sdIndex shown in filesList
+extern uint16_t filesPageCount;            // pages in sdIndex when listDir() last ran
+extern DirIndex sdIndex;
+extern SdCache sdCache;
+extern IoWorker ioWorker;
 extern String editingFile;
 extern String prevEditingFile;
 extern String excludedFiles[3];
@@ -219,16 +234,31 @@ extern uint8_t maxCharsPerLine;
 extern uint8_t maxLines;
 extern uint8_t fontHeight;
 extern uint8_t lineSpacing;
-extern volatile bool newLineAdded;
-extern volatile bool doFull;
+extern RenderFlag newLineAdded;
+extern RenderFlag doFull;
 extern std::vector<String> allLines;
 extern volatile long int dynamicScroll;
 extern volatile long int prev_dynamicScroll;
 extern int lastTouch;
 extern unsigned long lastTouchTime;
+extern PieceTable txtDoc;                  // TXT document, allLines is its wrapped layout
+extern size_t txtCursor;                   // cursor byte offset in txtDoc
+extern RowIndex lineStarts;                // txtDoc offset of each row in allLines
+extern volatile long cursorLine;           // row holding the cursor
+extern RenderFlag cursorMoved;             // cursor changed rows, repaint them
+extern TextViewer txtView;                 // read-only view of files over TXT_VIEW_THRESHOLD
 
 // <TASKS.cpp>
-extern std::vector<std::vector<String>> tasks;
+// One task. due is YYYYMMDD as an integer so it sorts and compares directly;
+// offset is where the task's record starts in SYS_TASKS_FILE
+struct Task {
+  String   name;
+  uint32_t due;
+  uint8_t  priority;
+  bool     completed;
+  uint32_t offset;
+};
+extern std::vector<Task> tasks;
 extern uint8_t selectedTask;
 enum TasksState { TASKS0, TASKS0_NEWTASK, TASKS1, TASKS1_EDITTASK };
 extern TasksState CurrentTasksState;
@@ -272,13 +302,16 @@ extern PokedexState CurrentPokedexState;
 // SYSTEM
 void checkTimeout();
 void PWR_BTN_irq();
+void MPR121_irq();
 void TCA8418_irq();
 char updateKeypress();
 void printDebug();
 String vectorToString();
 void stringToVector(String inputText);
 void saveFile();
-void writeMetadata(const String& path);
+void writeMetadata(const String& path, size_t fileSizeBytes, int charCount);
+void appendMetadata(const String& path, size_t bytesAdded, int charsAdded);
+void invalidateMetadataIndex();
 void loadFile(bool showOLED = true);
 void delFile(String fileName);
 void deleteMetadata(String path);
@@ -316,6 +349,7 @@ void getTextBoundsUTF8(const String& text, int16_t x, int16_t y, int16_t* x1, in
 bool loadKeyboardLayoutFromFile(const char* path);
 bool selectKeyboardLayout(const String& name); // loads /sys/kbd/<name>.json
 void applyLayoutToLegacyArrays();              // keeps old ASCII code working
+std::vector<uint8_t> compileKeyboardLayout(const KeyboardLayout& layout, uint32_t srcSize = 0, uint32_t srcMtime = 0);
 
 // UTF-8 helpers
 int  utf8_length(const String& s);             // number of codepoints
@@ -327,10 +361,13 @@ bool loadKeyboardLayout(const String& layoutName); // load keyboard layout
 KeyEvent updateKeypressUTF8();
 
 // microSD
-void listDir(fs::FS &fs, const char *dirname);
+void listDir();
+void prefetchDirIndex();
+void filesPageStep(int delta);
+void filesCycleSort();
 void readFile(fs::FS &fs, const char *path);
 String readFileToString(fs::FS &fs, const char *path);
-void writeFile(fs::FS &fs, const char *path, const char *message);
+bool writeFile(fs::FS &fs, const char *path, const char *message);
 void appendFile(fs::FS &fs, const char *path, const char *message);
 void renameFile(fs::FS &fs, const char *path1, const char *path2);
 void deleteFile(fs::FS &fs, const char *path);
@@ -338,9 +375,10 @@ void setTimeFromString(String timeStr);
 
 // <OLEDFunc.cpp>
 void oledWord(String word, bool allowLarge = false, bool showInfo = true);
-void oledLine(String line, bool doProgressBar = true, String bottomMsg = "");
+void oledLine(String line, bool doProgressBar = true, String bottomMsg = "", int cursorPos = -1);
 void oledScroll();
 void infoBar();
+void oledPresent();  // send the u8g2 buffer, changed tiles only
 
 // <einkFunc.cpp>
 void refresh();
@@ -350,10 +388,12 @@ void einkTextPartial(String text, bool noRefresh = false);
 void drawThickLine(int x0, int y0, int x1, int y1, int thickness);
 int  countLines(String input, size_t maxLineLength = 29);
 void einkTextDynamic(bool doFull_, bool noRefresh = false);
+void einkTextView();
 void setTXTFont(const GFXfont *font);
 void setFastFullRefresh(bool setting);
 void drawStatusBar(String input);
 void multiPassRefesh(int passes);
+void einkTextLine(long line);
 
 // <FILEWIZ.cpp>
 void FILEWIZ_INIT();
@@ -370,6 +410,10 @@ bool splitIntoLines(const char* input, int scroll_);
 int countWords(String str);
 int countVisibleChars(String input);
 void updateScrollFromTouch();
+void txtLayout();
+void txtWrapParagraph(const String& para, size_t base, std::vector<String>& rows, std::vector<uint32_t>& starts);
+bool txtLayoutAt(size_t pos, long delta);
+long txtLineForPos(size_t pos);
 
 // <HOME.cpp>
 void einkHandler_HOME();
@@ -379,12 +423,14 @@ void drawHome();
 
 // <TASKS.cpp>
 void TASKS_INIT();
-void sortTasksByDueDate(std::vector<std::vector<String>> &tasks);
-void addTask(String taskName, String dueDate, String priority, String completed);
+void sortTasksByDueDate(std::vector<Task> &tasks);
+void addTask(const String& taskName, uint32_t dueDate, uint8_t priority = 0);
 void updateTaskArray();
-void updateTasksFile();
+void invalidateTaskArray();
+void setTaskCompleted(int index, bool completed);
 void deleteTask(int index);
-String convertDateFormat(String yyyymmdd);
+uint32_t parseTaskDate(const String& yyyymmdd);
+String convertDateFormat(uint32_t yyyymmdd);
 void einkHandler_TASKS();
 void processKB_TASKS();
 
@@ -418,6 +464,8 @@ void einkHandler_LEXICON();
 void JOURNAL_INIT();
 void processKB_JOURNAL();
 void einkHandler_JOURNAL();
+void journalMarkEntry(const String& path, bool present);
+void invalidateJournalIndex();
 
 // <POKEDEX.cpp>
 void POKEDEX_INIT();
@@ -23,6 +23,41 @@ String newEventNote = "";
 std::vector<std::vector<String>> dayEvents;
 std::vector<std::vector<String>> calendarEvents;
 
+// Event store
+// calendarEvents is only re-parsed when events.txt changes on disk. A typed copy
+// of it (dates and repeat codes as integers) is expanded into per-month
+// occurrence maps, so the month/week views draw from RAM.
+enum RepeatKind : uint8_t { REPEAT_NONE, REPEAT_DAILY, REPEAT_WEEKLY, REPEAT_MONTHLY_DAY, REPEAT_MONTHLY_NTH, REPEAT_YEARLY, REPEAT_OTHER };
+
+struct CalEvent {
+  int32_t  date     = 0;   // YYYYMMDD, 0 if malformed
+  uint16_t minutes  = 0;   // start time
+  uint8_t  repeat   = REPEAT_NONE;
+  uint8_t  weekdays = 0;   // WEEKLY: bit per weekday, 0 = Sunday
+  uint8_t  day      = 0;   // MONTHLY 10 / YEARLY Apr22
+  uint8_t  month    = 0;   // YEARLY Apr22
+  uint8_t  nth      = 0;   // MONTHLY 2Tu
+  int8_t   weekday  = -1;  // MONTHLY 2Tu
+};
+
+struct MonthOccurrences {
+  int      year    = 0;
+  int      month   = 0;
+  uint32_t version = UINT32_MAX;
+  uint32_t days    = 0;                          // bit (d-1) set if day d has events
+  uint8_t  counts[32] = {0};                     // events per day, indexed by day
+  std::vector<std::pair<uint8_t, uint16_t>> list;  // (day, event index) by day, then start time
+};
+
+static time_t   eventsFileTime = 0;
+static size_t   eventsFileSize = 0;
+static bool     eventsLoaded   = false;
+static uint32_t eventsVersion  = 0;           // bumped whenever calendarEvents changes
+static uint32_t storeVersion   = UINT32_MAX;
+static std::vector<CalEvent> eventStore;
+static MonthOccurrences monthCache[2];        // week view can span two months
+static uint8_t monthCacheNext = 0;
+
 void CALENDAR_INIT() {
   currentLine = "";
   CurrentAppState = CALENDAR;
@@ -35,21 +70,29 @@ void CALENDAR_INIT() {
 
 // Event Data Management
 void updateEventArray() {
-  SDActive = true;
-  setCpuFrequencyMhz(240);
-  delay(50);
+  IoBoostSession ioBoost;
 
+  sdCache.flush("/sys/events.txt");
   File file = SD_MMC.open("/sys/events.txt", "r"); // Open the text file in read mode
   if (!file) {
     Serial.println("Failed to open file for reading");
     return;
   }
 
+  // Unchanged since the last parse, keep what we have
+  time_t fileTime = file.getLastWrite();
+  size_t fileSize = file.size();
+  if (eventsLoaded && fileTime == eventsFileTime && fileSize == eventsFileSize) {
+    file.close();
+    return;
+  }
+
   calendarEvents.clear(); // Clear the existing vector before loading the new data
 
   // Loop through the file, line by line
-  while (file.available()) {
-    String line = file.readStringUntil('\n');  // Read a line from the file
+  SdLineReader reader(file);
+  String line;
+  while (reader.readLine(line)) {
     line.trim();  // Remove any extra spaces or newlines
     
     // Skip empty lines
@@ -77,8 +120,10 @@ void updateEventArray() {
 
   file.close();  // Close the file
 
-  if (SAVE_POWER) setCpuFrequencyMhz(POWER_SAVE_FREQ);
-  SDActive = false;
+  eventsFileTime = fileTime;
+  eventsFileSize = fileSize;
+  eventsLoaded = true;
+  eventsVersion++;
 }
 
 void sortEventsByDate(std::vector<std::vector<String>> &calendarEvents) {
@@ -88,9 +133,7 @@ void sortEventsByDate(std::vector<std::vector<String>> &calendarEvents) {
 }
 
 void updateEventsFile() {
-  SDActive = true;
-  setCpuFrequencyMhz(240);
-  delay(50);
+  IoBoostSession ioBoost;
   // Clear the existing calendarEvents file first
   delFile("/sys/events.txt");
 
@@ -103,8 +146,9 @@ void updateEventsFile() {
     appendToFile("/sys/events.txt", eventInfo);
   }
 
-  if (SAVE_POWER) setCpuFrequencyMhz(POWER_SAVE_FREQ);
-  SDActive = false;
+  // Re-read on next use so the stored mtime matches the new file
+  eventsLoaded = false;
+  eventsVersion++;
 }
 
 void addEvent(String eventName, String startDate, String startTime , String duration, String repeat, String note) {
@@ -118,6 +162,7 @@ void addEvent(String eventName, String startDate, String startTime , String dura
 void deleteEvent(int index) {
   if (index >= 0 && index < calendarEvents.size()) {
     calendarEvents.erase(calendarEvents.begin() + index);
+    eventsVersion++;
   }
 }
 
@@ -132,6 +177,7 @@ void deleteEventByIndex(int indexToDelete) {
     for (int i = 0; i < calendarEvents.size(); i++) {
       if (calendarEvents[i] == targetEvent) {
         calendarEvents.erase(calendarEvents.begin() + i);
+        eventsVersion++;
         break;  // Only remove the first match
       }
     }
@@ -159,6 +205,7 @@ void updateEventByIndex(int indexToUpdate) {
     for (int i = 0; i < calendarEvents.size(); i++) {
       if (calendarEvents[i] == oldEvent) {
         calendarEvents[i] = updatedEvent;
+        eventsVersion++;
         break;  // Stop after first match
       }
     }
@@ -275,7 +322,7 @@ void commandSelectMonth(String command) {
         newState = true;
 
         // Update monthOffsetCount relative to now
-        DateTime now = rtc.now();
+        DateTime now = timeService.now();
         int currentAbsMonth = now.year() * 12 + now.month();
         int targetAbsMonth = currentYear * 12 + currentMonth;
         monthOffsetCount = targetAbsMonth - currentAbsMonth;
@@ -291,7 +338,7 @@ void commandSelectMonth(String command) {
     int month = command.substring(4, 6).toInt();
     int date = command.substring(6, 8).toInt();
 
-    if (year < 1970 || year > 2200 || month < 1 || month > 12 || date < 1 || date > daysInMonth(month, year)) {
+    if (year < 1970 || year > 2200 || month < 1 || month > 12 || date < 1 || date > daysInMonth(year, month)) {
       oledWord("Invalid");
       delay(500);
       return;
@@ -301,7 +348,7 @@ void commandSelectMonth(String command) {
     currentMonth = month;
     currentDate = date;
 
-    DateTime now = rtc.now();
+    DateTime now = timeService.now();
     int currentAbsMonth = now.year() * 12 + now.month();
     int targetAbsMonth = currentYear * 12 + currentMonth;
     monthOffsetCount = targetAbsMonth - currentAbsMonth;
@@ -340,8 +387,8 @@ void commandSelectMonth(String command) {
   // Check if user entered a numeric day (for current month)
   else {
     int intDay = stringToPositiveInt(command);
-    DateTime now = rtc.now();
-    if (intDay == -1 || intDay > daysInMonth(currentMonth, currentYear)) {
+    DateTime now = timeService.now();
+    if (intDay == -1 || intDay > daysInMonth(currentYear, currentMonth)) {
       oledWord("Invalid");
       delay(500);
       return;
@@ -406,7 +453,7 @@ void commandSelectWeek(String command) {
   else if (command == "sun" || command == "su") {
     CurrentCalendarState = SUN;
 
-    DateTime now = rtc.now();
+    DateTime now = timeService.now();
     int todayDOW = getDayOfWeek(now.year(), now.month(), now.day()); 
     DateTime currentSunday = now - TimeSpan(todayDOW, 0, 0, 0);
     DateTime viewedSunday = currentSunday + TimeSpan(weekOffsetCount * 7, 0, 0, 0);
@@ -422,7 +469,7 @@ void commandSelectWeek(String command) {
   else if (command == "mon" || command == "mo") {
     CurrentCalendarState = MON;
 
-    DateTime now = rtc.now();
+    DateTime now = timeService.now();
     int todayDOW = getDayOfWeek(now.year(), now.month(), now.day());
     DateTime currentSunday = now - TimeSpan(todayDOW, 0, 0, 0);
     DateTime viewedMonday = currentSunday + TimeSpan(weekOffsetCount * 7 + 1, 0, 0, 0);
@@ -438,7 +485,7 @@ void commandSelectWeek(String command) {
   else if (command == "tue" || command == "tu") {
     CurrentCalendarState = TUE;
 
-    DateTime now = rtc.now();
+    DateTime now = timeService.now();
     int todayDOW = getDayOfWeek(now.year(), now.month(), now.day());
     DateTime currentSunday = now - TimeSpan(todayDOW, 0, 0, 0);
     DateTime viewedTuesday = currentSunday + TimeSpan(weekOffsetCount * 7 + 2, 0, 0, 0);
@@ -454,7 +501,7 @@ void commandSelectWeek(String command) {
   else if (command == "wed" || command == "we") {
     CurrentCalendarState = WED;
 
-    DateTime now = rtc.now();
+    DateTime now = timeService.now();
     int todayDOW = getDayOfWeek(now.year(), now.month(), now.day());
     DateTime currentSunday = now - TimeSpan(todayDOW, 0, 0, 0);
     DateTime viewedWednesday = currentSunday + TimeSpan(weekOffsetCount * 7 + 3, 0, 0, 0);
@@ -470,7 +517,7 @@ void commandSelectWeek(String command) {
   else if (command == "thu" || command == "th") {
     CurrentCalendarState = THU;
 
-    DateTime now = rtc.now();
+    DateTime now = timeService.now();
     int todayDOW = getDayOfWeek(now.year(), now.month(), now.day());
     DateTime currentSunday = now - TimeSpan(todayDOW, 0, 0, 0);
     DateTime viewedThursday = currentSunday + TimeSpan(weekOffsetCount * 7 + 4, 0, 0, 0);
@@ -486,7 +533,7 @@ void commandSelectWeek(String command) {
   else if (command == "fri" || command == "fr") {
     CurrentCalendarState = FRI;
 
-    DateTime now = rtc.now();
+    DateTime now = timeService.now();
     int todayDOW = getDayOfWeek(now.year(), now.month(), now.day());
     DateTime currentSunday = now - TimeSpan(todayDOW, 0, 0, 0);
     DateTime viewedFriday = currentSunday + TimeSpan(weekOffsetCount * 7 + 5, 0, 0, 0);
@@ -502,7 +549,7 @@ void commandSelectWeek(String command) {
   else if (command == "sat" || command == "sa") {
     CurrentCalendarState = SAT;
 
-    DateTime now = rtc.now();
+    DateTime now = timeService.now();
     int todayDOW = getDayOfWeek(now.year(), now.month(), now.day());
     DateTime currentSunday = now - TimeSpan(todayDOW, 0, 0, 0);
     DateTime viewedSaturday = currentSunday + TimeSpan(weekOffsetCount * 7 + 6, 0, 0, 0);
@@ -561,137 +608,163 @@ void commandSelectDay(String command) {
   }
 }
 
-int checkEvents(String YYYYMMDD, bool countOnly = false) {
-  int eventCount = 0;
-
-  // Load events array from file
-  updateEventArray();
-
-  // Return -1 if input format is invalid
-  if (YYYYMMDD.length() != 8) return -1;
-
-  // Convert input to DateTime
-  int year  = YYYYMMDD.substring(0, 4).toInt();
-  int month = YYYYMMDD.substring(4, 6).toInt();
-  int day   = YYYYMMDD.substring(6, 8).toInt();
-  DateTime dt(year, month, day);
-
-  // Define helper strings
-  const char* daysOfWeek[] = { "Su", "Mo", "Tu", "We", "Th", "Fr", "Sa" };
-  const char* monthNames[] = {
-    "Jan", "Feb", "Mar", "Apr", "May", "Jun",
-    "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
-  };
+// Occurrence Maps
+static int weekdayFromCode(const String& code) {
+  const char* codes[] = { "SU", "MO", "TU", "WE", "TH", "FR", "SA" };
+  for (int i = 0; i < 7; i++) {
+    if (code == codes[i]) return i;
+  }
+  return -1;
+}
 
-  String weekday = String(daysOfWeek[dt.dayOfTheWeek()]);
-  String weekdayUpper = weekday;
-  weekdayUpper.toUpperCase();
+static int monthFromName(const String& name) {
+  const char* names[] = { "JAN", "FEB", "MAR", "APR", "MAY", "JUN", "JUL", "AUG", "SEP", "OCT", "NOV", "DEC" };
+  for (int i = 0; i < 12; i++) {
+    if (name == names[i]) return i + 1;
+  }
+  return 0;
+}
 
-  String dayStr = String(day);
-  String monthName = String(monthNames[month - 1]);
-  String dateCode = monthName + (day < 10 ? "0" + dayStr : dayStr);
-  dateCode.toUpperCase();
+// Parse one calendarEvents row into integer form
+static CalEvent parseEvent(const std::vector<String>& e) {
+  CalEvent ev;
+  if (e[1].length() == 8) ev.date = e[1].toInt();
+  ev.minutes = e[2].substring(0, 2).toInt() * 60 + e[2].substring(3, 5).toInt();
 
-  int weekdayIndex = dt.dayOfTheWeek();  // 0 = Sunday
-  int nthWeekday = ((day - 1) / 7) + 1;
+  if (e[4] == "NO") return ev;
+  ev.repeat = REPEAT_OTHER;
 
-  dayEvents.clear();  // Clear previous day's events
+  String code = e[4];
+  code.toUpperCase();
 
-  // Check whether any repeat events happen on this day
-  for (size_t i = 0; i < calendarEvents.size(); i++) {
-    String eventDate = calendarEvents[i][1];
-    String eventTime = calendarEvents[i][2];
-    String repeatCode = calendarEvents[i][4];
-
-    // Direct match
-    if (eventDate == YYYYMMDD) {
-      if (!countOnly) dayEvents.push_back(calendarEvents[i]);
-      eventCount++;
-      continue;
+  // DAILY
+  if (code == "DAILY") {
+    ev.repeat = REPEAT_DAILY;
+  }
+  // WEEKLY SU, MOWEFR, etc.
+  else if (code.startsWith("WEEKLY ")) {
+    String days = code.substring(7);
+    days.trim();
+    for (int j = 0; j + 1 < days.length(); j += 2) {
+      int wd = weekdayFromCode(days.substring(j, j + 2));
+      if (wd >= 0) ev.weekdays |= (1 << wd);
     }
+    ev.repeat = REPEAT_WEEKLY;
+  }
+  // MONTHLY 10 or 2Tu
+  else if (code.startsWith("MONTHLY ")) {
+    String monthlyCode = code.substring(8);
+    int day = monthlyCode.toInt();
+    if (day > 0 && String(day) == monthlyCode) {
+      ev.repeat = REPEAT_MONTHLY_DAY;
+      ev.day = day;
+    }
+    else if (monthlyCode.length() == 3) {
+      ev.repeat  = REPEAT_MONTHLY_NTH;
+      ev.nth     = monthlyCode.charAt(0) - '0';
+      ev.weekday = weekdayFromCode(monthlyCode.substring(1));
+    }
+  }
+  // YEARLY Apr22
+  else if (code.startsWith("YEARLY ")) {
+    String yearlyCode = code.substring(7);
+    if (yearlyCode.length() == 5) {
+      ev.repeat = REPEAT_YEARLY;
+      ev.month  = monthFromName(yearlyCode.substring(0, 3));
+      ev.day    = yearlyCode.substring(3).toInt();
+    }
+  }
 
-    // Handle repeating events
-    if (repeatCode != "NO") {
-      repeatCode.toUpperCase();
-
-      // Skip repeat if date is before original event date
-      if (eventDate.length() == 8 && YYYYMMDD < eventDate) continue;
+  return ev;
+}
 
-      // DAILY
-      if (repeatCode == "DAILY") {
-        if (!countOnly) dayEvents.push_back(calendarEvents[i]);
-        eventCount++;
-        continue;
-      }
+static bool occursOn(const CalEvent& ev, int32_t date, int month, int day, int weekday) {
+  // Direct match
+  if (ev.date == date) return true;
+  if (ev.repeat == REPEAT_NONE) return false;
+
+  // Repeats start on the original event date
+  if (ev.date != 0 && date < ev.date) return false;
+
+  switch (ev.repeat) {
+    case REPEAT_DAILY:       return true;
+    case REPEAT_WEEKLY:      return ev.weekdays & (1 << weekday);
+    case REPEAT_MONTHLY_DAY: return ev.day == day;
+    case REPEAT_MONTHLY_NTH: return ev.nth == ((day - 1) / 7) + 1 && ev.weekday == weekday;
+    case REPEAT_YEARLY:      return ev.month == month && ev.day == day;
+    default:                 return false;
+  }
+}
 
-      // WEEKLY SU, MOWEFR, etc.
-      if (repeatCode.startsWith("WEEKLY ")) {
-        String days = repeatCode.substring(7);
-        days.trim();
+// Expand every event into the occurrence map for one month (cached)
+static const MonthOccurrences& monthOccurrences(int year, int month) {
+  if (storeVersion != eventsVersion) {
+    eventStore.clear();
+    eventStore.reserve(calendarEvents.size());
+    for (const auto& e : calendarEvents) eventStore.push_back(parseEvent(e));
+    storeVersion = eventsVersion;
+  }
 
-        for (int j = 0; j + 1 < days.length(); j += 2) {
-          String codeDay = days.substring(j, j + 2);
-          if (codeDay == weekdayUpper) {
-            if (!countOnly) dayEvents.push_back(calendarEvents[i]);
-            eventCount++;
-            break;
-          }
-        }
-        continue;
-      }
+  for (auto& m : monthCache) {
+    if (m.year == year && m.month == month && m.version == eventsVersion) return m;
+  }
 
-      // MONTHLY 10 or 2Tu
-      if (repeatCode.startsWith("MONTHLY ")) {
-        String monthlyCode = repeatCode.substring(8);
+  MonthOccurrences& m = monthCache[monthCacheNext];
+  monthCacheNext = (monthCacheNext + 1) % 2;
+  m = MonthOccurrences();
+  m.year = year;
+  m.month = month;
+  m.version = eventsVersion;
+
+  int numDays  = daysInMonth(year, month);
+  int firstDow = getDayOfWeek(year, month, 1);
+  int32_t base = year * 10000 + month * 100;
+
+  for (size_t i = 0; i < eventStore.size(); i++) {
+    for (int day = 1; day <= numDays; day++) {
+      if (!occursOn(eventStore[i], base + day, month, day, (firstDow + day - 1) % 7)) continue;
+      m.list.push_back({(uint8_t)day, (uint16_t)i});
+      m.days |= (1UL << (day - 1));
+      if (m.counts[day] < 255) m.counts[day]++;
+    }
+  }
 
-        // Monthly on specific date (e.g. 10)
-        if (monthlyCode == dayStr) {
-          if (!countOnly) dayEvents.push_back(calendarEvents[i]);
-          eventCount++;
-          continue;
-        }
+  // By day, then start time
+  std::sort(m.list.begin(), m.list.end(), [](const std::pair<uint8_t, uint16_t>& a, const std::pair<uint8_t, uint16_t>& b) {
+    if (a.first != b.first) return a.first < b.first;
+    if (eventStore[a.second].minutes != eventStore[b.second].minutes) return eventStore[a.second].minutes < eventStore[b.second].minutes;
+    return a.second < b.second;
+  });
 
-        // Monthly on ordinal weekday (e.g. 2Tu)
-        if (monthlyCode.length() == 3) {
-          int nth = monthlyCode.charAt(0) - '0';
-          String codeWeekday = monthlyCode.substring(1);
-          codeWeekday.toUpperCase();
+  return m;
+}
 
-          if (nth == nthWeekday && codeWeekday == weekdayUpper) {
-            if (!countOnly) dayEvents.push_back(calendarEvents[i]);
-            eventCount++;
-            continue;
-          }
-        }
-      }
+// Count (and unless countOnly, collect into dayEvents) the events on one day
+static int eventsOnDay(int year, int month, int day, bool countOnly) {
+  dayEvents.clear();  // Clear previous day's events
+  if (month < 1 || month > 12 || day < 1 || day > daysInMonth(year, month)) return 0;
 
-      // YEARLY Apr22
-      if (repeatCode.startsWith("YEARLY ")) {
-        String yearlyCode = repeatCode.substring(7);
-        yearlyCode.toUpperCase();
-        if (yearlyCode == dateCode) {
-          if (!countOnly) dayEvents.push_back(calendarEvents[i]);
-          eventCount++;
-          continue;
-        }
-      }
+  const MonthOccurrences& m = monthOccurrences(year, month);
+  if (!countOnly) {
+    for (const auto& o : m.list) {
+      if (o.first == day) dayEvents.push_back(calendarEvents[o.second]);
     }
   }
+  return m.counts[day];
+}
 
-  // Sort by start time (HH:MM to minutes)
-  if (!countOnly) {
-    std::sort(dayEvents.begin(), dayEvents.end(), [](const std::vector<String>& a, const std::vector<String>& b) {
-      String aTime = a[2];
-      String bTime = b[2];
+int checkEvents(String YYYYMMDD, bool countOnly = false) {
+  // Load events array from file (no-op unless it changed)
+  updateEventArray();
 
-      int aMin = aTime.substring(0, 2).toInt() * 60 + aTime.substring(3, 5).toInt();
-      int bMin = bTime.substring(0, 2).toInt() * 60 + bTime.substring(3, 5).toInt();
+  // Return -1 if input format is invalid
+  if (YYYYMMDD.length() != 8) return -1;
 
-      return aMin < bMin;
-    });
-  }
+  int year  = YYYYMMDD.substring(0, 4).toInt();
+  int month = YYYYMMDD.substring(4, 6).toInt();
+  int day   = YYYYMMDD.substring(6, 8).toInt();
 
-  return eventCount;
+  return eventsOnDay(year, month, day, countOnly);
 }
 
 void drawCalendarMonth(int monthOffset) {
@@ -700,7 +773,7 @@ void drawCalendarMonth(int monthOffset) {
   int CELL_W = 44;     // Width of each cell
   int CELL_H = 27;     // Height of each cell
 
-  DateTime now = rtc.now();
+  DateTime now = timeService.now();
 
   // Step 1: Calculate target month/year
   int month = now.month() + monthOffset;
@@ -741,6 +814,9 @@ void drawCalendarMonth(int monthOffset) {
   }
 
   // Step 6: Draw day numbers and events
+  updateEventArray();
+  const MonthOccurrences& occurrences = monthOccurrences(year, month);
+
   for (int i = 0; i < daysInMonth; ++i) {
     int dayIndex = i + startDay;     // total box index in the 7x6 grid
     int row = dayIndex / 7;
@@ -762,16 +838,8 @@ void drawCalendarMonth(int monthOffset) {
     display.print(dayNum);
 
     // Draw icon if there are events on day
-
-    String YYYYMMDD = intToYYYYMMDD(year, month, dayNum);
-    // Pad month and dayNum with leading zeros
-    /*String paddedMonth = (month < 10 ? "0" : "") + String(month);
-    String paddedDay   = (dayNum < 10 ? "0" : "") + String(dayNum);
-
-    // Format date as YYYYMMDD
-    String YYYYMMDD = String(year) + paddedMonth + paddedDay;*/
-
-    int numEvents = checkEvents(YYYYMMDD, true);
+    if (!(occurrences.days & (1UL << (dayNum - 1)))) continue;
+    int numEvents = occurrences.counts[dayNum];
 
     // Events found
     if (numEvents > 2) {
@@ -795,7 +863,7 @@ void drawCalendarWeek(int weekOffset) {
   display.drawBitmap(0, 0, calendar_allArray[0], 320, 218, GxEPD_BLACK);
 
   // Get current date
-  DateTime now = rtc.now();
+  DateTime now = timeService.now();
   int year = now.year();
   int month = now.month();
   int day = now.day();
@@ -804,6 +872,8 @@ void drawCalendarWeek(int weekOffset) {
   // Calculate how many days to go back to get to Sunday, adjusted by weekOffset
   int totalOffset = -dow + (weekOffset * 7);
 
+  updateEventArray();
+
   for (int i = 0; i < 7; i++) {
     // Compute day offset from today
     int offset = totalOffset + i;
@@ -820,10 +890,10 @@ void drawCalendarWeek(int weekOffset) {
         m = 12;
         y--;
       }
-      d += daysInMonth(m, y);
+      d += daysInMonth(y, m);
     }
-    while (d > daysInMonth(m, y)) {
-      d -= daysInMonth(m, y);
+    while (d > daysInMonth(y, m)) {
+      d -= daysInMonth(y, m);
       m++;
       if (m > 12) {
         m = 1;
@@ -831,12 +901,6 @@ void drawCalendarWeek(int weekOffset) {
       }
     }
 
-    // Format YYYYMMDD
-    String YYYYMMDD = intToYYYYMMDD(y, m, d);
-    /*String YYYYMMDD = String(y) +
-                      (m < 10 ? "0" : "") + String(m) +
-                      (d < 10 ? "0" : "") + String(d);*/
-
     // Draw date
     display.setFont(&FreeSerif9pt7b);
     display.setTextColor(GxEPD_BLACK);
@@ -845,7 +909,7 @@ void drawCalendarWeek(int weekOffset) {
     display.print(dateStr);
 
     // Load and draw events
-    int eventCount = checkEvents(YYYYMMDD, false);
+    int eventCount = eventsOnDay(y, m, d, false);
     if (eventCount > 6) eventCount = 6;
 
     // Blank out extra space
@@ -874,7 +938,7 @@ void drawCalendarWeek(int weekOffset) {
 // Loops
 void processKB_CALENDAR() {
   int currentMillis = millis();
-  DateTime now = rtc.now();
+  DateTime now = timeService.now();
 
   switch (CurrentCalendarState) {
     case MONTH:
@@ -1489,7 +1553,7 @@ void processKB_CALENDAR() {
               currentMonth = 12;
               currentYear--;
             }
-            currentDate = daysInMonth(currentMonth, currentYear);
+            currentDate = daysInMonth(currentYear, currentMonth);
           }
 
           int dayOfWeek = getDayOfWeek(currentYear, currentMonth, currentDate);
@@ -1509,7 +1573,7 @@ void processKB_CALENDAR() {
         // RIGHT Received
         else if (inchar == 21) {
           // Go forward one day
-          int daysThisMonth = daysInMonth(currentMonth, currentYear);
+          int daysThisMonth = daysInMonth(currentYear, currentMonth);
           currentDate++;
           if (currentDate > daysThisMonth) {
             currentDate = 1;
@@ -1565,8 +1629,7 @@ void processKB_CALENDAR() {
 void einkHandler_CALENDAR() {
   switch (CurrentCalendarState) {
     case WEEK:
-      if (newState) {
-        newState = false;
+      if (newState.take()) {
         display.setRotation(3);
         display.setFullWindow();
         display.fillScreen(GxEPD_WHITE);
@@ -1580,8 +1643,7 @@ void einkHandler_CALENDAR() {
       }
       break;
     case MONTH:
-      if (newState) {
-        newState = false;
+      if (newState.take()) {
         display.setRotation(3);
         display.setFullWindow();
         display.fillScreen(GxEPD_WHITE);
@@ -1595,8 +1657,7 @@ void einkHandler_CALENDAR() {
       }
       break;
     case NEW_EVENT:
-      if (newState) {
-        newState = false;
+      if (newState.take()) {
         display.setRotation(3);
         display.setFullWindow();
         display.fillScreen(GxEPD_WHITE);
@@ -1628,8 +1689,7 @@ void einkHandler_CALENDAR() {
       }
       break;
     case VIEW_EVENT:
-      if (newState) {
-        newState = false;
+      if (newState.take()) {
         display.setRotation(3);
         display.setFullWindow();
         display.fillScreen(GxEPD_WHITE);
@@ -1676,8 +1736,7 @@ void einkHandler_CALENDAR() {
     case THU:
     case FRI:
     case SAT:
-      if (newState) {
-        newState = false;
+      if (newState.take()) {
         display.setRotation(3);
         display.setFullWindow();
         display.fillScreen(GxEPD_WHITE);
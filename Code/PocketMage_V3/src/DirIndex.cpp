@@ -0,0 +1,229 @@
+#include "globals.h"
+#include <esp_heap_caps.h>
+
+// Paths handled here carry a leading '/', entries store them without it
+static String withSlash(const String& path) {
+  return path.startsWith("/") ? path : "/" + path;
+}
+
+static String baseName(const String& path) {
+  int slash = path.lastIndexOf('/');
+  return (slash < 0) ? path : path.substring(slash + 1);
+}
+
+static char* poolAlloc(size_t size) {
+  return (char*)(psramFound() ? ps_malloc(size) : malloc(size));
+}
+
+// Room for one more entry without crowding out the rest of the firmware
+static bool heapRoom() {
+  return heap_caps_get_free_size(MALLOC_CAP_INTERNAL) > DIR_INDEX_MIN_FREE_HEAP;
+}
+
+// PATH POOL
+bool DirIndex::add(const String& rel, uint32_t size, uint32_t mtime) {
+  if (entries.size() >= DIR_INDEX_MAX_ENTRIES || !heapRoom()) return false;
+
+  size_t need = rel.length() + 1;
+  if (poolUsed + need > poolCap) {
+    size_t cap = poolCap ? poolCap : DIR_INDEX_POOL_CHUNK;
+    while (poolUsed + need > cap) cap *= 2;
+    char* grown = poolAlloc(cap);
+    if (!grown) return false;
+    if (pool) {
+      memcpy(grown, pool, poolUsed);
+      free(pool);
+    }
+    pool = grown;
+    poolCap = cap;
+  }
+
+  memcpy(pool + poolUsed, rel.c_str(), need);
+  entries.push_back({(uint32_t)poolUsed, size, mtime});
+  poolUsed += need;
+  return true;
+}
+
+void DirIndex::remove(size_t i) {
+  poolDead += strlen(pathOf(entries[i])) + 1;
+  entries.erase(entries.begin() + i);
+  if (poolDead > DIR_INDEX_POOL_CHUNK && poolDead * 2 > poolUsed) repack();
+}
+
+// Slide the live paths down over the removed ones, in pool order
+void DirIndex::repack() {
+  std::vector<uint16_t> byOffset(entries.size());
+  for (size_t i = 0; i < byOffset.size(); i++) byOffset[i] = i;
+  std::sort(byOffset.begin(), byOffset.end(), [this](uint16_t a, uint16_t b) {
+    return entries[a].path < entries[b].path;
+  });
+
+  size_t at = 0;
+  for (uint16_t i : byOffset) {
+    size_t len = strlen(pathOf(entries[i])) + 1;
+    memmove(pool + at, pool + entries[i].path, len);
+    entries[i].path = at;
+    at += len;
+  }
+  poolUsed = at;
+  poolDead = 0;
+}
+
+bool DirIndex::indexable(const String& path) const {
+  if (path.startsWith("/sys/")) return false;
+  for (const String& excluded : excludedFiles) {
+    if (path.equals(excluded)) return false;
+  }
+  return true;
+}
+
+void DirIndex::scan(const String& dir, uint8_t depth) {
+  File root = SD_MMC.open(dir);
+  if (!root || !root.isDirectory()) return;
+
+  File file = root.openNextFile();
+  while (file && entries.size() < DIR_INDEX_MAX_ENTRIES && heapRoom()) {
+    String child = (dir.endsWith("/") ? dir : dir + "/") + baseName(String(file.name()));
+
+    if (file.isDirectory()) {
+      file.close();
+      if (child != "/sys" && depth < DIR_INDEX_MAX_DEPTH) scan(child, depth + 1);
+    }
+    else {
+      if (indexable(child)) add(child.substring(1), (uint32_t)file.size(), (uint32_t)file.getLastWrite());
+      file.close();
+    }
+    file = root.openNextFile();
+  }
+  root.close();
+}
+
+void DirIndex::ensure() {
+  if (!scanned && !noSD) {
+    IoBoostSession ioBoost;
+    sdCache.flushAll();  // so queued appends show in the sizes
+    invalidate();
+    scan("/", 0);
+    scanned = true;
+    sorted  = false;
+    Serial.println("Directory index: " + String((int)entries.size()) + " files");
+  }
+
+  if (!sorted) {
+    order.resize(entries.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+
+    const std::vector<DirEntry>& e = entries;
+    switch (sortBy) {
+      case SORT_NAME:
+        std::sort(order.begin(), order.end(), [this, &e](uint16_t a, uint16_t b) {
+          return strcasecmp(pathOf(e[a]), pathOf(e[b])) < 0;
+        });
+        break;
+      case SORT_DATE:
+        std::sort(order.begin(), order.end(), [&e](uint16_t a, uint16_t b) { return e[a].mtime > e[b].mtime; });
+        break;
+      case SORT_SIZE:
+        std::sort(order.begin(), order.end(), [&e](uint16_t a, uint16_t b) { return e[a].size > e[b].size; });
+        break;
+    }
+    sorted = true;
+  }
+}
+
+size_t DirIndex::size() {
+  ensure();
+  return order.size();
+}
+
+String DirIndex::path(size_t i) {
+  ensure();
+  return String(pathOf(entries[order[i]]));
+}
+
+String DirIndex::find(const String& name) {
+  ensure();
+  String key = name.startsWith("/") ? name.substring(1) : name;
+
+  for (const DirEntry& e : entries) {
+    const char* path  = pathOf(e);
+    const char* slash = strrchr(path, '/');
+    const char* base  = slash ? slash + 1 : path;
+    if (strcasecmp(path, key.c_str()) == 0 || strcasecmp(base, key.c_str()) == 0) return String(path);
+  }
+  return "";
+}
+
+void DirIndex::setSort(DirSort key) {
+  if (key == sortBy) return;
+  sortBy = key;
+  sorted = false;
+}
+
+size_t DirIndex::pageCount(size_t perPage) {
+  size_t n = size();
+  return (n == 0) ? 1 : (n + perPage - 1) / perPage;
+}
+
+void DirIndex::fillPage(size_t page, String* out, size_t perPage) {
+  size_t n = size();
+  for (size_t i = 0; i < perPage; i++) {
+    size_t idx = page * perPage + i;
+    out[i] = (idx < n) ? path(idx) : "-";
+  }
+}
+
+void DirIndex::update(const String& path) {
+  // Not walked yet, the first walk will see the change
+  if (!scanned) return;
+
+  String full = withSlash(path);
+  String rel  = full.substring(1);
+  if (!indexable(full)) return;
+
+  // Whatever was under path as a directory is gone or renamed; a directory
+  // now at path is walked again below
+  String prefix = rel + "/";
+  long slot = -1;
+  for (size_t i = 0; i < entries.size();) {
+    if (strncmp(pathOf(entries[i]), prefix.c_str(), prefix.length()) == 0) {
+      remove(i);
+      continue;
+    }
+    if (strcmp(pathOf(entries[i]), rel.c_str()) == 0) slot = i;
+    i++;
+  }
+
+  File file = SD_MMC.open(full);
+  if (file && file.isDirectory()) {
+    file.close();
+    uint8_t depth = 0;
+    for (size_t i = 0; i < full.length(); i++) depth += (full[i] == '/');
+    if (slot >= 0) remove(slot);
+    if (full != "/sys" && depth <= DIR_INDEX_MAX_DEPTH) scan(full, depth);
+    sorted = false;
+    return;
+  }
+  if (file && !file.isDirectory()) {
+    if (slot >= 0) {
+      entries[slot].size  = file.size();
+      entries[slot].mtime = file.getLastWrite();
+    }
+    else add(rel, file.size(), file.getLastWrite());
+  }
+  else if (slot >= 0) {
+    remove(slot);
+  }
+  if (file) file.close();
+  sorted = false;
+}
+
+void DirIndex::invalidate() {
+  scanned = false;
+  sorted  = false;
+  std::vector<DirEntry>().swap(entries);
+  std::vector<uint16_t>().swap(order);
+  free(pool);
+  pool = nullptr;
+  poolUsed = poolCap = poolDead = 0;
+}
@@ -0,0 +1,183 @@
+#include "EinkCompositor.h"
+#include "config.h"
+#include <algorithm>
+#include <string.h>
+
+#ifndef DESKTOP_EMULATOR
+
+void EinkCompositor::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  EinkPanel::drawPixel(x, y, color);
+  if (x < 0 || y < 0 || x >= width() || y >= height()) return;
+
+  uint8_t& b = frame[y * stride() + x / 8];
+  uint8_t mask = 0x80 >> (x & 7);
+  if (color == GxEPD_WHITE) b &= ~mask;
+  else                      b |= mask;
+}
+
+void EinkCompositor::fillScreen(uint16_t color) {
+  EinkPanel::fillScreen(color);
+  uint8_t fill = (color == GxEPD_WHITE) ? 0x00 : 0xFF;
+
+  if (!partialWindow) {
+    memset(frame, fill, sizeof(frame));
+    return;
+  }
+  for (int16_t y = window.y; y < window.y + window.h && y < height(); y++) {
+    for (int16_t x = window.x; x < window.x + window.w && x < width(); x++) {
+      uint8_t mask = 0x80 >> (x & 7);
+      if (fill) frame[y * stride() + x / 8] |= mask;
+      else      frame[y * stride() + x / 8] &= ~mask;
+    }
+  }
+}
+
+void EinkCompositor::setRotation(uint8_t r) {
+  if (r != getRotation()) {
+    // Both copies and the tiles are kept in logical coordinates
+    panelValid = false;
+    memset(frame, 0, sizeof(frame));
+    memset(ghost, 0, sizeof(ghost));
+  }
+  EinkPanel::setRotation(r);
+}
+
+void EinkCompositor::setFullWindow() {
+  partialWindow = false;
+  EinkPanel::setFullWindow();
+}
+
+void EinkCompositor::setPartialWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+  partialWindow = true;
+  window = {(int16_t)x, (int16_t)y, (int16_t)w, (int16_t)h};
+  EinkPanel::setPartialWindow(x, y, w, h);
+}
+
+void EinkCompositor::display(bool partial_update_mode) {
+  EinkPanel::display(partial_update_mode);
+  if (partialWindow) {
+    recordPartial(window.x, window.y, window.w, window.h);
+    markShown(window.x, window.y, window.w, window.h);
+  }
+  else if (partial_update_mode) {
+    recordPartial(0, 0, width(), height());
+    markShown(0, 0, width(), height());
+  }
+  else {
+    recordFull();
+    memcpy(shown, frame, sizeof(shown));
+    panelValid = true;
+  }
+}
+
+void EinkCompositor::displayWindow(int16_t x, int16_t y, int16_t w, int16_t h) {
+  EinkPanel::displayWindow(x, y, w, h);
+  recordPartial(x, y, w, h);
+  markShown(x, y, w, h);
+}
+
+bool EinkCompositor::nextPage() {
+  bool more = EinkPanel::nextPage();
+  if (partialWindow) {
+    recordPartial(window.x, window.y, window.w, window.h);
+    markShown(window.x, window.y, window.w, window.h);
+  }
+  else {
+    recordFull();
+    memcpy(shown, frame, sizeof(shown));
+    panelValid = true;
+  }
+  return more;
+}
+
+// GHOSTING
+// Pixels about to change between shown and frame, per tile, into flips
+void EinkCompositor::countFlips(int16_t x, int16_t y, int16_t w, int16_t h) {
+  memset(flips, 0, sizeof(flips));
+  int16_t x0 = std::max<int16_t>(0, x) / 8;
+  int16_t x1 = (std::min<int16_t>(width(), x + w) + 7) / 8;
+  int16_t y1 = std::min<int16_t>(height(), y + h);
+  for (int16_t row = std::max<int16_t>(0, y); row < y1; row++) {
+    const uint8_t* a = &frame[row * stride()];
+    const uint8_t* b = &shown[row * stride()];
+    for (int16_t col = x0; col < x1; col++) {
+      uint8_t diff = a[col] ^ b[col];
+      if (diff) flips[row / EINK_GHOST_TILE][col * 8 / EINK_GHOST_TILE] += __builtin_popcount(diff);
+    }
+  }
+}
+
+void EinkCompositor::recordPartial(int16_t x, int16_t y, int16_t w, int16_t h) {
+  countFlips(x, y, w, h);
+  for (int r = 0; r < GHOST_TILES; r++) {
+    for (int c = 0; c < GHOST_TILES; c++) ghost[r][c].partialGhost += flips[r][c];
+  }
+}
+
+// A slow full refresh clears everything; a fast one clears most of the partial
+// ghosting but leaves a residue that grows with what it had to flip
+void EinkCompositor::recordFull() {
+  bool fast = GxEPD2_310_GDEQ031T10::useFastFullUpdate;
+  countFlips(0, 0, width(), height());
+  for (int r = 0; r < GHOST_TILES; r++) {
+    for (int c = 0; c < GHOST_TILES; c++) {
+      GhostTile& t = ghost[r][c];
+      if (fast) t.residue += t.partialGhost / EINK_GHOST_CARRY_DIVISOR + flips[r][c] / EINK_GHOST_FAST_DIVISOR;
+      else      t.residue = 0;
+      t.partialGhost = 0;
+    }
+  }
+}
+
+uint32_t EinkCompositor::partialGhostWith(const EinkRect& r) {
+  countFlips(r.x, r.y, r.w, r.h);
+  uint32_t worst = 0;
+  for (int row = 0; row < GHOST_TILES; row++) {
+    for (int c = 0; c < GHOST_TILES; c++) {
+      if (flips[row][c]) worst = std::max(worst, ghost[row][c].partialGhost + flips[row][c]);
+    }
+  }
+  return worst;
+}
+
+uint32_t EinkCompositor::fullResidue() const {
+  uint32_t worst = 0;
+  for (int r = 0; r < GHOST_TILES; r++) {
+    for (int c = 0; c < GHOST_TILES; c++) worst = std::max(worst, ghost[r][c].residue);
+  }
+  return worst;
+}
+
+// The controller works in whole bytes, so partial windows are byte aligned too
+void EinkCompositor::markShown(int16_t x, int16_t y, int16_t w, int16_t h) {
+  int16_t x0 = std::max<int16_t>(0, x) / 8;
+  int16_t x1 = (std::min<int16_t>(width(), x + w) + 7) / 8;
+  int16_t y1 = std::min<int16_t>(height(), y + h);
+  for (int16_t row = std::max<int16_t>(0, y); row < y1; row++) {
+    memcpy(&shown[row * stride() + x0], &frame[row * stride() + x0], x1 - x0);
+  }
+}
+
+EinkRect EinkCompositor::damage() {
+  int s = stride();
+  int x0 = s, x1 = -1, y0 = -1, y1 = -1;   // in bytes / rows
+
+  for (int y = 0; y < height(); y++) {
+    const uint8_t* a = &frame[y * s];
+    const uint8_t* b = &shown[y * s];
+    int lo = 0, hi = s - 1;
+    while (lo < s && a[lo] == b[lo]) lo++;
+    if (lo == s) continue;
+    while (hi > lo && a[hi] == b[hi]) hi--;
+
+    if (y0 < 0) y0 = y;
+    y1 = y;
+    x0 = std::min(x0, lo);
+    x1 = std::max(x1, hi);
+  }
+
+  if (y0 < 0) return {0, 0, 0, 0};
+  return {(int16_t)(x0 * 8), (int16_t)y0, (int16_t)((x1 - x0 + 1) * 8), (int16_t)(y1 - y0 + 1)};
+}
+
+#endif
@@ -44,6 +44,16 @@ void processKB_FILEWIZ() {
           newState = true;
           break;
         }
+        // PAGE AND SORT THE FILE LIST
+        else if (inchar == KB_KEY_LEFT || inchar == KB_KEY_RIGHT) {
+          uint16_t prevPage = filesPage;
+          filesPageStep(inchar == KB_KEY_LEFT ? -1 : 1);
+          if (filesPage != prevPage) newState = true;
+        }
+        else if (inchar == KB_KEY_SELECT) {
+          filesCycleSort();
+          newState = true;
+        }
         else if (inchar >= '0' && inchar <= '9') {
           int fileIndex = (inchar == '0') ? 10 : (inchar - '0');
           // SET WORKING FILE
@@ -304,21 +314,20 @@ void processKB_FILEWIZ() {
 void einkHandler_FILEWIZ() {
   switch (CurrentFileWizState) {
     case WIZ0_:
-      if (newState) {
-        newState = false;
+      if (newState.take()) {
         display.setRotation(3);
         display.setFullWindow();
         display.fillScreen(GxEPD_WHITE);
 
-        // DRAW APP
-        drawStatusBar("Select a File (0-9)");
-        display.drawBitmap(0, 0, fileWizardallArray[0], 320, 218, GxEPD_BLACK);
-
         // DRAW FILE LIST
         keypad.disableInterrupts();
-        listDir(SD_MMC, "/");
+        listDir();
         keypad.enableInterrupts();
 
+        // DRAW APP
+        drawStatusBar("Select a File (0-9) " + String(filesPage + 1) + "/" + String(filesPageCount));
+        display.drawBitmap(0, 0, fileWizardallArray[0], 320, 218, GxEPD_BLACK);
+
         for (int i = 0; i < MAX_FILES; i++) {
           display.setCursor(30, 54+(17*i));
           display.print(filesList[i]);
@@ -328,8 +337,7 @@ void einkHandler_FILEWIZ() {
       }
       break;
     case WIZ1_:
-      if (newState) {
-        newState = false;
+      if (newState.take()) {
         display.setRotation(3);
         display.setFullWindow();
         display.fillScreen(GxEPD_WHITE);
@@ -342,8 +350,7 @@ void einkHandler_FILEWIZ() {
       }
       break;
     case WIZ1_YN:
-      if (newState) {
-        newState = false;
+      if (newState.take()) {
         display.setRotation(3);
         display.setFullWindow();
         display.fillScreen(GxEPD_WHITE);
@@ -356,8 +363,7 @@ void einkHandler_FILEWIZ() {
       }
       break;
     case WIZ2_R:
-      if (newState) {
-        newState = false;
+      if (newState.take()) {
         display.setRotation(3);
         display.setFullWindow();
         display.fillScreen(GxEPD_WHITE);
@@ -370,8 +376,7 @@ void einkHandler_FILEWIZ() {
       }
       break;
     case WIZ2_C:
-      if (newState) {
-        newState = false;
+      if (newState.take()) {
         display.setRotation(3);
         display.setFullWindow();
         display.fillScreen(GxEPD_WHITE);
@@ -13,6 +13,16 @@
 // Forward declarations
 void PERIODIC_INIT();
 
+// Path of the file a command names, with or without ".txt", or "" if none
+static String matchFile(const String& name) {
+  keypad.disableInterrupts();
+  SdBusLock bus;
+  String match = sdIndex.find(name);
+  if (match == "") match = sdIndex.find(name + ".txt");
+  keypad.enableInterrupts();
+  return match;
+}
+
 void commandSelect(String command) {
   std::cout << "[POCKETMAGE] commandSelect() called with: '" << command.c_str() << "'" << std::endl;
   command.toLowerCase();
@@ -22,21 +32,15 @@ void commandSelect(String command) {
   if (command.startsWith("-")) {
     command = removeChar(command, ' ');
     command = removeChar(command, '-');
-    keypad.disableInterrupts();
-    listDir(SD_MMC, "/");
-    keypad.enableInterrupts();
+    String path = noSD ? "" : matchFile(command);
 
-    for (uint8_t i = 0; i < (sizeof(filesList) / sizeof(filesList[0])); i++) {
-      String lowerFileName = filesList[i]; 
-      lowerFileName.toLowerCase();
-      if (command == lowerFileName || (command+".txt") == lowerFileName || ("/"+command+".txt") == lowerFileName) {
-        workingFile = filesList[i];
-        CurrentAppState = FILEWIZ;
-        CurrentFileWizState = WIZ1_;
-        CurrentKBState  = FUNC;
-        newState = true;
-        return;
-      }
+    if (path != "") {
+      workingFile = path;
+      CurrentAppState = FILEWIZ;
+      CurrentFileWizState = WIZ1_;
+      CurrentKBState  = FUNC;
+      newState = true;
+      return;
     }
   }
 
@@ -44,22 +48,16 @@ void commandSelect(String command) {
   if (command.startsWith("/")) {
     command = removeChar(command, ' ');
     command = removeChar(command, '/');
-    keypad.disableInterrupts();
-    listDir(SD_MMC, "/");
-    keypad.enableInterrupts();
+    String path = noSD ? "" : matchFile(command);
 
-    for (uint8_t i = 0; i < (sizeof(filesList) / sizeof(filesList[0])); i++) {
-      String lowerFileName = filesList[i]; 
-      lowerFileName.toLowerCase();
-      if (command == lowerFileName || (command+".txt") == lowerFileName || ("/"+command+".txt") == lowerFileName) {
-        editingFile = filesList[i];
-        loadFile();
-        CurrentAppState = TXT;
-        CurrentTXTState = TXT_;
-        CurrentKBState  = NORMAL;
-        newLineAdded = true;
-        return;
-      }
+    if (path != "") {
+      editingFile = path;
+      loadFile();
+      CurrentAppState = TXT;
+      CurrentTXTState = TXT_;
+      CurrentKBState  = NORMAL;
+      newLineAdded = true;
+      return;
     }
   }
 
@@ -256,12 +254,7 @@ void processKB_HOME() {
       break;
 
     case NOWLATER:
-      DateTime now = rtc.now();
-      if (prevTime != now.minute()) {
-        prevTime = now.minute();
-        newState = true;
-      }
-      else newState = false;
+      if (timeService.minuteChanged(prevTime)) newState = true;
       break;
   }
 }
@@ -269,16 +262,14 @@ void processKB_HOME() {
 void einkHandler_HOME() {
   switch (CurrentHOMEState) {
     case HOME_HOME:
-      if (newState) {
-        newState = false;
+      if (newState.take()) {
         drawHome(); // drawHome() already handles clearing and refreshing
         //multiPassRefesh(2);
       }
       break;
 
     case NOWLATER:
-      if (newState) {
-        newState = false;
+      if (newState.take()) {
 
         // BACKGROUND
         display.drawBitmap(0, 0, nowLaterallArray[0], 320, 240, GxEPD_BLACK);
@@ -294,7 +285,7 @@ void einkHandler_HOME() {
         uint8_t centerX     = 76;
         uint8_t centerY     = 94;
 
-        DateTime now = rtc.now();
+        DateTime now = timeService.now();
 
         // Convert time to proper angles in radians
         float minuteAngle = (now.minute() / 60.0) * 2 * pi;  
@@ -316,12 +307,14 @@ void einkHandler_HOME() {
         if (!tasks.empty()) {
           if (DEBUG_VERBOSE) Serial.println("Printing Tasks");
 
-          int loopCount = std::min((int)tasks.size(), 7);
-          for (int i = 0; i < loopCount; i++) {
+          int shown = 0;
+          for (size_t i = 0; i < tasks.size() && shown < 7; i++) {
+            if (tasks[i].completed) continue;
             display.setFont(&FreeSerif9pt7b);
             // PRINT TASK NAME
-            display.setCursor(151, 68 + (25 * i));
-            display.print(tasks[i][0].c_str());
+            display.setCursor(151, 68 + (25 * shown));
+            display.print(tasks[i].name.c_str());
+            shown++;
           }
         }
 
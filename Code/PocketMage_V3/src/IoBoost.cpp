@@ -0,0 +1,47 @@
+#include "globals.h"
+
+std::atomic<int>  IoBoostSession::depth(0);
+std::atomic<int>  IoBoostSession::pinned(0);
+std::atomic<bool> IoBoostSession::boosted(false);
+volatile unsigned long IoBoostSession::releasedAt = 0;
+
+IoBoostSession::IoBoostSession() {
+  depth++;
+  SDActive = true;
+  if (!boosted.exchange(true)) setCpuFrequencyMhz(240);
+}
+
+IoBoostSession::~IoBoostSession() {
+  releasedAt = millis();
+  if (--depth == 0) SDActive = false;
+}
+
+void IoBoostSession::idle() {
+  if (depth > 0 || pinned > 0 || !boosted || millis() - releasedAt < IO_BOOST_IDLE_MS) return;
+  release();
+}
+
+void IoBoostSession::boost() {
+  releasedAt = millis();
+  if (!boosted.exchange(true)) setCpuFrequencyMhz(240);
+}
+
+void IoBoostSession::release() {
+  if (depth > 0 || pinned > 0) return;  // idle() lowers it once the session ends
+
+  boosted = false;
+  if (SAVE_POWER) setCpuFrequencyMhz(POWER_SAVE_FREQ);
+
+  // A session that started meanwhile saw the clock still up
+  if ((depth > 0 || pinned > 0) && !boosted.exchange(true)) setCpuFrequencyMhz(240);
+}
+
+void IoBoostSession::pin() {
+  pinned++;
+  boost();
+}
+
+void IoBoostSession::unpin() {
+  releasedAt = millis();
+  pinned--;
+}
@@ -0,0 +1,108 @@
+#include "globals.h"
+
+#ifndef DESKTOP_EMULATOR
+static QueueHandle_t     jobQueue   = nullptr;
+static TaskHandle_t      workerTask = nullptr;
+static SemaphoreHandle_t sdMutex    = nullptr;
+#endif
+
+void IoWorker::begin() {
+#ifndef DESKTOP_EMULATOR
+  if (workerTask) return;
+  if (!sdMutex) sdMutex = xSemaphoreCreateRecursiveMutex();
+  jobQueue = xQueueCreate(IO_QUEUE_LEN, sizeof(Request*));
+
+  xTaskCreatePinnedToCore(
+    task,                    // Function name
+    "ioWorkerTask",          // Task name
+    IO_WORKER_STACK,         // Stack size (in bytes)
+    this,                    // Parameters
+    1,                       // Priority (below einkHandler work, same as loop)
+    &workerTask,             // Task handle
+    0                        // Core ID
+  );
+#endif
+}
+
+bool IoWorker::onWorker() const {
+#ifdef DESKTOP_EMULATOR
+  return false;
+#else
+  return workerTask && xTaskGetCurrentTaskHandle() == workerTask;
+#endif
+}
+
+bool IoWorker::submit(Job job, Done done) {
+  Request* req = new Request{job, done, false};
+
+#ifndef DESKTOP_EMULATOR
+  if (workerTask) {
+    outstanding++;
+    if (xQueueSend(jobQueue, &req, 0) == pdTRUE) return true;
+    outstanding--;
+  }
+#endif
+
+  // No worker or the queue is full: run it here. Its SD access still waits
+  // for the queued jobs, so ordering holds.
+  req->ok = req->job();
+  finish(req);
+  return false;
+}
+
+void IoWorker::finish(Request* req) {
+  req->job = nullptr;  // release captured buffers now
+  if (!req->done) {
+    delete req;
+    return;
+  }
+  std::lock_guard<std::mutex> guard(doneLock);
+  doneList.push_back(req);
+}
+
+void IoWorker::task(void* param) {
+#ifndef DESKTOP_EMULATOR
+  IoWorker* self = static_cast<IoWorker*>(param);
+  for (;;) {
+    Request* req = nullptr;
+    if (xQueueReceive(jobQueue, &req, portMAX_DELAY) != pdTRUE) continue;
+    req->ok = req->job();
+    self->finish(req);
+    self->outstanding--;
+  }
+#else
+  (void)param;
+#endif
+}
+
+void IoWorker::poll() {
+  std::vector<Request*> ready;
+  {
+    std::lock_guard<std::mutex> guard(doneLock);
+    ready.swap(doneList);
+  }
+  for (Request* req : ready) {
+    req->done(req->ok);
+    delete req;
+  }
+}
+
+void IoWorker::drain() {
+  if (onWorker()) return;
+  while (outstanding.load() > 0) delay(2);
+}
+
+// SD BUS LOCK
+SdBusLock::SdBusLock() {
+#ifndef DESKTOP_EMULATOR
+  if (!sdMutex) sdMutex = xSemaphoreCreateRecursiveMutex();
+  if (xSemaphoreGetMutexHolder(sdMutex) != xTaskGetCurrentTaskHandle()) ioWorker.drain();
+  xSemaphoreTakeRecursive(sdMutex, portMAX_DELAY);
+#endif
+}
+
+SdBusLock::~SdBusLock() {
+#ifndef DESKTOP_EMULATOR
+  xSemaphoreGiveRecursive(sdMutex);
+#endif
+}
@@ -24,6 +24,7 @@ void loadJournal() {
 void saveJournal() {
   editingFile = currentJournal;
   saveFile();
+  journalMarkEntry(currentJournal, true);
 }
 
 // Functions
@@ -31,120 +32,236 @@ bool isLeapYear(int year) {
   return ((year % 4 == 0) && (year % 100 != 0)) || (year % 400 == 0);
 }
 
-void drawJMENU() {
-  SDActive = true;
-  setCpuFrequencyMhz(240);
-  delay(50);
+// Journal Index
+// One presence bit per day of the year (46 bytes) for every year with entries,
+// stored in JOURNAL_INDEX_FILE as [year lo][year hi][46 bytes] records. The
+// year grid draws from it instead of probing SD for each of the 365 files.
+// A header fingerprints /journal (entry count and newest mtime), so entries
+// added or removed while the card was elsewhere trigger a rebuild:
+//   "JIX1" | count (uint32 LE) | newest mtime (uint32 LE) | records
+#define JOURNAL_INDEX_BYTES  46
+#define JOURNAL_INDEX_MAGIC  "JIX1"
+#define JOURNAL_INDEX_HEADER 12
+
+struct JournalYear {
+  uint16_t year;
+  uint8_t  bits[JOURNAL_INDEX_BYTES];
+};
+
+static std::vector<JournalYear> journalIndex;
+static bool journalIndexLoaded = false;
+static uint32_t journalCount  = 0;  // fingerprint of /journal the index matches
+static uint32_t journalNewest = 0;
+
+static int dayOfYear(int year, int month, int day) {
+  static const int daysBefore[12] = { 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334 };
+  int doy = daysBefore[month - 1] + day - 1;
+  if (month > 2 && isLeapYear(year)) doy++;
+  return doy;
+}
 
-  // Display background
-  drawStatusBar("Type:YYYYMMDD or (T)oday");
-  display.drawBitmap(0, 0, _journal, 320, 218, GxEPD_BLACK);
+static int journalDaysInMonth(int year, int month) {
+  static const int days[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+  return (month == 2 && isLeapYear(year)) ? 29 : days[month - 1];
+}
 
-  // Update current progress graph
-  DateTime now = rtc.now();
-  String year = String(now.year());
-
-  // Files are in the format "/journal/YYYYMMDD.txt"
-  // JANUARY
-  for (int i = 1; i < 31; i++) {
-    String dayCode = "";
-    if (i<10) dayCode = "0"+String(i);
-    else dayCode = String(i);
-    
-    String fileCode = "/journal/" + year + "01" + dayCode + ".txt";
-    if (SD_MMC.exists(fileCode)) display.fillRect(91 + (7*(i-1)), 50, 4, 4, GxEPD_BLACK);
-  }
-  // FEBRUARY
-  int febDays = isLeapYear(year.toInt()) ? 29 : 28;
-  for (int i = 1; i <= febDays; i++) {
-    String dayCode = (i < 10) ? "0" + String(i) : String(i);
-    String fileCode = "/journal/" + year + "02" + dayCode + ".txt";
-    if (SD_MMC.exists(fileCode)) display.fillRect(91 + (7 * (i - 1)), 59, 4, 4, GxEPD_BLACK);
+// "YYYYMMDD.txt" -> year and day of year
+static bool parseJournalName(const String& name, int& year, int& doy) {
+  if (name.length() != 12 || !name.endsWith(".txt")) return false;
+  for (int i = 0; i < 8; i++) {
+    if (!isDigit(name[i])) return false;
   }
 
-  // MARCH
-  for (int i = 1; i <= 31; i++) {
-    String dayCode = (i < 10) ? "0" + String(i) : String(i);
-    String fileCode = "/journal/" + year + "03" + dayCode + ".txt";
-    if (SD_MMC.exists(fileCode)) display.fillRect(91 + (7 * (i - 1)), 68, 4, 4, GxEPD_BLACK);
-  }
+  year      = name.substring(0, 4).toInt();
+  int month = name.substring(4, 6).toInt();
+  int day   = name.substring(6, 8).toInt();
+  if (month < 1 || month > 12 || day < 1 || day > journalDaysInMonth(year, month)) return false;
 
-  // APRIL
-  for (int i = 1; i <= 30; i++) {
-    String dayCode = (i < 10) ? "0" + String(i) : String(i);
-    String fileCode = "/journal/" + year + "04" + dayCode + ".txt";
-    if (SD_MMC.exists(fileCode)) display.fillRect(91 + (7 * (i - 1)), 77, 4, 4, GxEPD_BLACK);
-  }
+  doy = dayOfYear(year, month, day);
+  return true;
+}
 
-  // MAY
-  for (int i = 1; i <= 31; i++) {
-    String dayCode = (i < 10) ? "0" + String(i) : String(i);
-    String fileCode = "/journal/" + year + "05" + dayCode + ".txt";
-    if (SD_MMC.exists(fileCode)) display.fillRect(91 + (7 * (i - 1)), 86, 4, 4, GxEPD_BLACK);
+static JournalYear& journalYear(int year) {
+  for (auto& y : journalIndex) {
+    if (y.year == year) return y;
   }
+  JournalYear y = { (uint16_t)year, {0} };
+  journalIndex.push_back(y);
+  return journalIndex.back();
+}
 
-  // JUNE
-  for (int i = 1; i <= 30; i++) {
-    String dayCode = (i < 10) ? "0" + String(i) : String(i);
-    String fileCode = "/journal/" + year + "06" + dayCode + ".txt";
-    if (SD_MMC.exists(fileCode)) display.fillRect(91 + (7 * (i - 1)), 95, 4, 4, GxEPD_BLACK);
-  }
+static void putU32(uint8_t* b, uint32_t v) {
+  for (int i = 0; i < 4; i++) b[i] = (uint8_t)(v >> (8 * i));
+}
 
-  // JULY
-  for (int i = 1; i <= 31; i++) {
-    String dayCode = (i < 10) ? "0" + String(i) : String(i);
-    String fileCode = "/journal/" + year + "07" + dayCode + ".txt";
-    if (SD_MMC.exists(fileCode)) display.fillRect(91 + (7 * (i - 1)), 104, 4, 4, GxEPD_BLACK);
+static uint32_t getU32(File& f) {
+  uint32_t v = 0;
+  for (int i = 0; i < 4; i++) v |= (uint32_t)(f.read() & 0xFF) << (8 * i);
+  return v;
+}
+
+static void writeJournalIndex() {
+  File file = SD_MMC.open(JOURNAL_INDEX_FILE, FILE_WRITE);
+  if (!file) {
+    Serial.println("Failed to write journal index");
+    return;
   }
 
-  // AUGUST
-  for (int i = 1; i <= 31; i++) {
-    String dayCode = (i < 10) ? "0" + String(i) : String(i);
-    String fileCode = "/journal/" + year + "08" + dayCode + ".txt";
-    if (SD_MMC.exists(fileCode)) display.fillRect(91 + (7 * (i - 1)), 113, 4, 4, GxEPD_BLACK);
+  uint8_t header[JOURNAL_INDEX_HEADER];
+  memcpy(header, JOURNAL_INDEX_MAGIC, 4);
+  putU32(header + 4, journalCount);
+  putU32(header + 8, journalNewest);
+  file.write(header, JOURNAL_INDEX_HEADER);
+
+  for (const auto& y : journalIndex) {
+    uint8_t header[2] = { (uint8_t)(y.year & 0xFF), (uint8_t)(y.year >> 8) };
+    file.write(header, 2);
+    file.write(y.bits, JOURNAL_INDEX_BYTES);
   }
+  file.close();
+}
 
-  // SEPTEMBER
-  for (int i = 1; i <= 30; i++) {
-    String dayCode = (i < 10) ? "0" + String(i) : String(i);
-    String fileCode = "/journal/" + year + "09" + dayCode + ".txt";
-    if (SD_MMC.exists(fileCode)) display.fillRect(91 + (7 * (i - 1)), 122, 4, 4, GxEPD_BLACK);
+// Single pass over /journal, marking entries in the index when fill is set
+static void scanJournalDir(bool fill, uint32_t& count, uint32_t& newest) {
+  count = newest = 0;
+
+  File dir = SD_MMC.open("/journal");
+  if (dir && dir.isDirectory()) {
+    File entry = dir.openNextFile();
+    while (entry) {
+      String name = entry.name();
+      int slash = name.lastIndexOf('/');
+      if (slash >= 0) name = name.substring(slash + 1);
+
+      int year, doy;
+      if (!entry.isDirectory() && parseJournalName(name, year, doy)) {
+        count++;
+        newest = max(newest, (uint32_t)entry.getLastWrite());
+        if (fill) journalYear(year).bits[doy / 8] |= (1 << (doy % 8));
+      }
+      entry.close();
+      entry = dir.openNextFile();
+    }
   }
+  if (dir) dir.close();
+}
+
+static void rebuildJournalIndex() {
+  Serial.println("Rebuilding journal index");
+  journalIndex.clear();
+  scanJournalDir(true, journalCount, journalNewest);
+  writeJournalIndex();
+  journalIndexLoaded = true;
+}
 
-  // OCTOBER
-  for (int i = 1; i <= 31; i++) {
-    String dayCode = (i < 10) ? "0" + String(i) : String(i);
-    String fileCode = "/journal/" + year + "10" + dayCode + ".txt";
-    if (SD_MMC.exists(fileCode)) display.fillRect(91 + (7 * (i - 1)), 131, 4, 4, GxEPD_BLACK);
+static void loadJournalIndex() {
+  if (journalIndexLoaded) return;
+
+  const size_t recordSize = 2 + JOURNAL_INDEX_BYTES;
+  File file;
+  if (SD_MMC.exists(JOURNAL_INDEX_FILE)) file = SD_MMC.open(JOURNAL_INDEX_FILE, FILE_READ);
+
+  // Missing, damaged or older than /journal, rebuild it
+  bool ok = file && file.size() >= JOURNAL_INDEX_HEADER &&
+            (file.size() - JOURNAL_INDEX_HEADER) % recordSize == 0;
+  if (ok) {
+    char magic[4];
+    for (int i = 0; i < 4; i++) magic[i] = file.read();
+    journalCount  = getU32(file);
+    journalNewest = getU32(file);
+
+    uint32_t count, newest;
+    scanJournalDir(false, count, newest);
+    ok = memcmp(magic, JOURNAL_INDEX_MAGIC, 4) == 0 && count == journalCount && newest == journalNewest;
+  }
+  if (!ok) {
+    if (file) file.close();
+    rebuildJournalIndex();
+    return;
   }
 
-  // NOVEMBER
-  for (int i = 1; i <= 30; i++) {
-    String dayCode = (i < 10) ? "0" + String(i) : String(i);
-    String fileCode = "/journal/" + year + "11" + dayCode + ".txt";
-    if (SD_MMC.exists(fileCode)) display.fillRect(91 + (7 * (i - 1)), 140, 4, 4, GxEPD_BLACK);
+  journalIndex.clear();
+  while (file.available()) {
+    JournalYear y;
+    y.year  = file.read();
+    y.year |= file.read() << 8;
+    for (int i = 0; i < JOURNAL_INDEX_BYTES; i++) y.bits[i] = file.read();
+    journalIndex.push_back(y);
   }
+  file.close();
+  journalIndexLoaded = true;
+}
 
-  // DECEMBER
-  for (int i = 1; i <= 31; i++) {
-    String dayCode = (i < 10) ? "0" + String(i) : String(i);
-    String fileCode = "/journal/" + year + "12" + dayCode + ".txt";
-    if (SD_MMC.exists(fileCode)) display.fillRect(91 + (7 * (i - 1)), 149, 4, 4, GxEPD_BLACK);
+// Record that /journal/YYYYMMDD.txt now exists (or no longer does)
+void journalMarkEntry(const String& path, bool present) {
+  if (!path.startsWith("/journal/")) return;
+
+  int year, doy;
+  if (!parseJournalName(path.substring(9), year, doy)) return;
+
+  loadJournalIndex();
+  uint8_t& byte = journalYear(year).bits[doy / 8];
+  uint8_t mask  = 1 << (doy % 8);
+  bool changed = ((byte & mask) != 0) != present;
+
+  // Keep the fingerprint in step. A removed entry can't lower the newest
+  // mtime, the next load just rebuilds if it was the newest one.
+  if (changed) journalCount += present ? 1 : -1;
+  if (present) {
+    File file = SD_MMC.open(path);
+    if (file) {
+      uint32_t mtime = file.getLastWrite();
+      file.close();
+      if (mtime > journalNewest) {
+        journalNewest = mtime;
+        changed = true;
+      }
+    }
   }
+  if (!changed) return;  // Already up to date
+
+  if (present) byte |= mask;
+  else         byte &= ~mask;
+  writeJournalIndex();
+}
+
+// Drop the index so it is rebuilt on next use (e.g. after USB file transfer)
+void invalidateJournalIndex() {
+  journalIndexLoaded = false;
+  if (SD_MMC.exists(JOURNAL_INDEX_FILE)) SD_MMC.remove(JOURNAL_INDEX_FILE);
+}
+
+void drawJMENU() {
+  IoBoostSession ioBoost;
 
-  if (SAVE_POWER) setCpuFrequencyMhz(POWER_SAVE_FREQ);
-  SDActive = false;
+  // Display background
+  drawStatusBar("Type:YYYYMMDD or (T)oday");
+  display.drawBitmap(0, 0, _journal, 320, 218, GxEPD_BLACK);
+
+  // Update current progress graph
+  DateTime now = timeService.now();
+
+  // One row per month, one dot per day with an entry
+  loadJournalIndex();
+  const JournalYear& entries = journalYear(now.year());
+  for (int month = 1; month <= 12; month++) {
+    int firstDay = dayOfYear(now.year(), month, 1);
+    for (int i = 1; i <= journalDaysInMonth(now.year(), month); i++) {
+      int doy = firstDay + i - 1;
+      if (entries.bits[doy / 8] & (1 << (doy % 8))) {
+        display.fillRect(91 + (7 * (i - 1)), 50 + (9 * (month - 1)), 4, 4, GxEPD_BLACK);
+      }
+    }
+  }
 }
 
 void JMENUCommand(String command) {
-  SDActive = true;
-  setCpuFrequencyMhz(240);
-  delay(50);
+  IoBoostSession ioBoost;
 
   command.toLowerCase();
 
   if (command == "t") {
-    DateTime now = rtc.now();
+    DateTime now = timeService.now();
 
     String dayStr = "";
     if (now.day() < 10) dayStr = "0" + String(now.day());
@@ -160,6 +277,7 @@ void JMENUCommand(String command) {
     if (!SD_MMC.exists(fileName)) {
       File f = SD_MMC.open(fileName, FILE_WRITE);
       if (f) f.close();
+      journalMarkEntry(fileName, true);
     }
 
     currentJournal = fileName;
@@ -181,6 +299,7 @@ void JMENUCommand(String command) {
     if (!SD_MMC.exists(fileName)) {
       File f = SD_MMC.open(fileName, FILE_WRITE);
       if (f) f.close();
+      journalMarkEntry(fileName, true);
     }
 
     currentJournal = fileName;
@@ -211,7 +330,7 @@ void JMENUCommand(String command) {
 
       int month = (monthIndex / 3) + 1;
 
-      String year = String(rtc.now().year());
+      String year = String(timeService.now().year());
       String m = (month < 10) ? "0" + String(month) : String(month);
       String d = (day < 10) ? "0" + String(day) : String(day);
       String fileName = "/journal/" + year + m + d + ".txt";
@@ -219,6 +338,7 @@ void JMENUCommand(String command) {
       if (!SD_MMC.exists(fileName)) {
         File f = SD_MMC.open(fileName, FILE_WRITE);
         if (f) f.close();
+        journalMarkEntry(fileName, true);
       }
 
       currentJournal = fileName;
@@ -233,9 +353,6 @@ void JMENUCommand(String command) {
       return;
     }
   }
-
-  if (SAVE_POWER) setCpuFrequencyMhz(POWER_SAVE_FREQ);
-  SDActive = false;
 }
 
 // Loops
@@ -444,8 +561,7 @@ void processKB_JOURNAL() {
 void einkHandler_JOURNAL() {
   switch (CurrentJournalState) {
     case J_MENU:
-      if (newState) {
-        newState = false;
+      if (newState.take()) {
 
         display.fillScreen(GxEPD_WHITE);
         drawJMENU();
@@ -453,20 +569,19 @@ void einkHandler_JOURNAL() {
         multiPassRefesh(2);
       }
       break;
-    case J_TXT:
-      if (newState) {
+    case J_TXT: {
+      uint32_t req = renderQueue.take(RENDER_STATE | RENDER_LINE);
+      if (req & RENDER_STATE) {
         display.fillScreen(GxEPD_WHITE);
-        if (doFull) {
+        if (doFull.pending()) {
           refresh();
         }
       }
-      if (newLineAdded && !newState) {
+      else if (req & RENDER_LINE) {
         einkTextDynamic(true);
         refresh();
       }
-
-      newState = false;
-      newLineAdded = false;
       break;
+    }
   } 
 }
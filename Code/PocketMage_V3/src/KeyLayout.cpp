@@ -0,0 +1,257 @@
+#include "globals.h"
+#include <algorithm>
+
+#define KBL_MAGIC "KBL1"
+#define KBL_KEYS  (3 * 4 * 10)
+
+// One codepoint from UTF-8, 0 if s is empty or holds more than one
+static uint32_t singleCodepoint(const char* s) {
+  const uint8_t* p = (const uint8_t*)s;
+  if (!p || !*p) return 0;
+
+  uint32_t cp;
+  int extra;
+  if      (p[0] < 0x80)           { cp = p[0];        extra = 0; }
+  else if ((p[0] & 0xE0) == 0xC0) { cp = p[0] & 0x1F; extra = 1; }
+  else if ((p[0] & 0xF0) == 0xE0) { cp = p[0] & 0x0F; extra = 2; }
+  else if ((p[0] & 0xF8) == 0xF0) { cp = p[0] & 0x07; extra = 3; }
+  else return 0;
+
+  for (int i = 1; i <= extra; i++) {
+    if ((p[i] & 0xC0) != 0x80) return 0;
+    cp = (cp << 6) | (p[i] & 0x3F);
+  }
+  return p[extra + 1] == 0 ? cp : 0;
+}
+
+static uint32_t ruleHash(uint32_t accent, uint32_t base, uint32_t seed) {
+  uint64_t h = (((uint64_t)accent << 21) | base) ^ ((uint64_t)seed * 0x9E3779B97F4A7C15ull);
+  h ^= h >> 33;
+  h *= 0xFF51AFD7ED558CCDull;
+  h ^= h >> 33;
+  h *= 0xC4CEB9FE1A85EC53ull;
+  h ^= h >> 33;
+  return (uint32_t)h;
+}
+
+// Section offsets, shared by the builder and the loader
+static size_t cellsAt()                  { return sizeof(CompiledLayout::Header); }
+static size_t dispAt()                   { return cellsAt() + KBL_KEYS * sizeof(CompiledLayout::Cell); }
+static size_t slotsAt(uint16_t buckets)  { return (dispAt() + buckets * sizeof(uint16_t) + 3) & ~(size_t)3; }
+static size_t poolAt(uint16_t buckets, uint16_t slots) {
+  return slotsAt(buckets) + slots * sizeof(CompiledLayout::Slot);
+}
+
+// COMPILED LAYOUT
+bool CompiledLayout::adopt(std::vector<uint8_t>& data) {
+  if (data.size() < sizeof(Header)) return false;
+  const Header* h = (const Header*)data.data();
+  if (memcmp(h->magic, KBL_MAGIC, 4) != 0) return false;
+
+  size_t poolStart = poolAt(h->buckets, h->slots);
+  if (data.size() != poolStart + h->poolSize || h->poolSize == 0) return false;
+  if (data[data.size() - 1] != 0 || h->nameOffset >= h->poolSize) return false;
+  if ((h->slots == 0) != (h->buckets == 0)) return false;
+
+  blob.swap(data);
+  const uint8_t* base = blob.data();
+  header = (const Header*)base;
+  cells  = (const Cell*)(base + cellsAt());
+  disp   = (const uint16_t*)(base + dispAt());
+  slots  = (const Slot*)(base + slotsAt(header->buckets));
+  pool   = (const char*)(base + poolStart);
+  return true;
+}
+
+bool CompiledLayout::loadFile(const char* path, uint32_t srcSize, uint32_t srcMtime) {
+  File f = SD_MMC.open(path, FILE_READ);
+  if (!f) return false;
+
+  std::vector<uint8_t> data(f.size());
+  bool ok = data.size() >= sizeof(Header) && f.read(data.data(), data.size()) == data.size();
+  f.close();
+  if (!ok) return false;
+
+  // Stale if the JSON changed since it was compiled
+  const Header* h = (const Header*)data.data();
+  if (h->srcSize != srcSize || h->srcMtime != srcMtime) return false;
+  return adopt(data);
+}
+
+const char* CompiledLayout::name() const {
+  return header ? pool + header->nameOffset : "";
+}
+
+uint8_t CompiledLayout::action(uint8_t layer, uint8_t row, uint8_t col) const {
+  if (!header || layer > 2 || row > 3 || col > 9) return KA_NONE;
+  return cells[(layer * 4 + row) * 10 + col].action;
+}
+
+const char* CompiledLayout::text(uint8_t layer, uint8_t row, uint8_t col) const {
+  if (!header || layer > 2 || row > 3 || col > 9) return "";
+  return pool + cells[(layer * 4 + row) * 10 + col].offset;
+}
+
+const char* CompiledLayout::compose(const char* accent, const char* base) const {
+  if (!header || header->slots == 0) return nullptr;
+  uint32_t a = singleCodepoint(accent);
+  uint32_t b = singleCodepoint(base);
+  if (!a || !b) return nullptr;
+
+  uint16_t d = disp[ruleHash(a, b, 0) % header->buckets];
+  const Slot& s = slots[ruleHash(a, b, d) % header->slots];
+  return (s.accent == a && s.base == b) ? pool + s.offset : nullptr;
+}
+
+// BUILDER
+void KeyLayoutBuilder::setKey(uint8_t layer, uint8_t row, uint8_t col, uint8_t action, const String& text) {
+  if (layer > 2 || row > 3 || col > 9) return;
+  keys[layer][row][col].action = action;
+  keys[layer][row][col].text = text;
+}
+
+bool KeyLayoutBuilder::addDead(const String& accent, const String& base, const String& out) {
+  uint32_t a = singleCodepoint(accent.c_str());
+  uint32_t b = singleCodepoint(base.c_str());
+  if (!a || !b) return false;
+
+  for (Rule& r : rules) {
+    if (r.accent == a && r.base == b) {
+      r.out = out;
+      return true;
+    }
+  }
+  rules.push_back({a, b, out});
+  return true;
+}
+
+std::vector<uint8_t> KeyLayoutBuilder::build(uint32_t srcSize, uint32_t srcMtime) const {
+  // String pool, offset 0 is the empty string
+  std::vector<char> strings(1, '\0');
+  auto intern = [&](const String& s) -> uint16_t {
+    if (s.length() == 0) return 0;
+    uint16_t at = strings.size();
+    strings.insert(strings.end(), s.c_str(), s.c_str() + s.length() + 1);
+    return at;
+  };
+
+  CompiledLayout::Cell cells[KBL_KEYS];
+  for (int l = 0; l < 3; l++) {
+    for (int r = 0; r < 4; r++) {
+      for (int c = 0; c < 10; c++) {
+        const Key& k = keys[l][r][c];
+        CompiledLayout::Cell& cell = cells[(l * 4 + r) * 10 + c];
+        cell.action = k.action;
+        cell.length = k.text.length();
+        cell.offset = intern(k.text);
+      }
+    }
+  }
+  uint16_t nameOffset = intern(layoutName);
+
+  // Hash and displace: rules are grouped into buckets of about four, and
+  // each bucket gets the first seed that lands all its rules on free slots
+  size_t n = rules.size();
+  uint16_t buckets = n ? (n + 3) / 4 : 0;
+  uint16_t slotCount = n ? n + n / 4 + 1 : 0;
+  std::vector<uint16_t> disp(buckets, 0);
+  std::vector<int> owner;
+
+  while (n) {
+    std::vector<std::vector<int>> members(buckets);
+    for (size_t i = 0; i < n; i++) members[ruleHash(rules[i].accent, rules[i].base, 0) % buckets].push_back(i);
+
+    std::vector<int> order(buckets);
+    for (int b = 0; b < buckets; b++) order[b] = b;
+    std::sort(order.begin(), order.end(), [&](int x, int y) { return members[x].size() > members[y].size(); });
+
+    owner.assign(slotCount, -1);
+    bool placed = true;
+    for (int b : order) {
+      if (members[b].empty()) break;
+      bool found = false;
+      for (uint32_t d = 1; d <= 0xFFFF && !found; d++) {
+        std::vector<uint16_t> want;
+        found = true;
+        for (int i : members[b]) {
+          uint16_t s = ruleHash(rules[i].accent, rules[i].base, d) % slotCount;
+          if (owner[s] != -1 || std::find(want.begin(), want.end(), s) != want.end()) {
+            found = false;
+            break;
+          }
+          want.push_back(s);
+        }
+        if (found) {
+          for (size_t k = 0; k < want.size(); k++) owner[want[k]] = members[b][k];
+          disp[b] = d;
+        }
+      }
+      if (!found) {
+        placed = false;
+        break;
+      }
+    }
+    if (placed) break;
+    slotCount += slotCount / 4 + 1;  // more room and try again
+  }
+
+  std::vector<CompiledLayout::Slot> slots(slotCount);
+  for (uint16_t s = 0; s < slotCount; s++) {
+    CompiledLayout::Slot& slot = slots[s];
+    memset(&slot, 0, sizeof(slot));
+    if (owner[s] < 0) continue;
+    const Rule& r = rules[owner[s]];
+    slot.accent = r.accent;
+    slot.base   = r.base;
+    slot.length = r.out.length();
+    slot.offset = intern(r.out);
+  }
+
+  CompiledLayout::Header h;
+  memcpy(h.magic, KBL_MAGIC, 4);
+  h.srcSize    = srcSize;
+  h.srcMtime   = srcMtime;
+  h.buckets    = buckets;
+  h.slots      = slotCount;
+  h.poolSize   = strings.size();
+  h.nameOffset = nameOffset;
+
+  std::vector<uint8_t> out(poolAt(buckets, slotCount) + strings.size(), 0);
+  memcpy(out.data(), &h, sizeof(h));
+  memcpy(out.data() + cellsAt(), cells, sizeof(cells));
+  if (buckets) memcpy(out.data() + dispAt(), disp.data(), buckets * sizeof(uint16_t));
+  if (slotCount) memcpy(out.data() + slotsAt(buckets), slots.data(), slotCount * sizeof(CompiledLayout::Slot));
+  memcpy(out.data() + poolAt(buckets, slotCount), strings.data(), strings.size());
+  return out;
+}
+
+// LAYOUT GLUE
+std::vector<uint8_t> compileKeyboardLayout(const KeyboardLayout& layout, uint32_t srcSize, uint32_t srcMtime) {
+  KeyLayoutBuilder b;
+  b.setName(layout.name);
+  for (int r = 0; r < 4; r++) {
+    for (int c = 0; c < 10; c++) {
+      b.setKey(NORMAL, r, c, layout.normal[r][c].action, layout.normal[r][c].text);
+      b.setKey(SHIFT,  r, c, layout.shift_[r][c].action, layout.shift_[r][c].text);
+      b.setKey(FUNC,   r, c, layout.fn[r][c].action,     layout.fn[r][c].text);
+    }
+  }
+  for (const auto& accent : layout.deadKeys) {
+    for (const auto& rule : accent.second) {
+      if (!b.addDead(accent.first, rule.first, rule.second)) {
+        Serial.println("Skipping dead key " + accent.first + " + " + rule.first + ", not a single character");
+      }
+    }
+  }
+  return b.build(srcSize, srcMtime);
+}
+
+// Dead-key composition (data-driven)
+String composeDeadIfAny(const String& base) {
+  if (CurrentDead.length() == 0) return base;
+  const char* out = ActiveLayout.compose(CurrentDead.c_str(), base.c_str());
+  // fallback: emit accent + base
+  String composed = out ? String(out) : CurrentDead + base;
+  CurrentDead = "";
+  return composed;
+}
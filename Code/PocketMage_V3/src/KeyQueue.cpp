@@ -0,0 +1,86 @@
+#include "globals.h"
+
+#ifndef DESKTOP_EMULATOR
+static TaskHandle_t drainTask = nullptr;
+#endif
+
+void KeyQueue::begin() {
+#ifndef DESKTOP_EMULATOR
+  if (drainTask) return;
+  xTaskCreatePinnedToCore(
+    task,                    // Function name
+    "kbDrainTask",           // Task name
+    KB_DRAIN_STACK,          // Stack size (in bytes)
+    this,                    // Parameters
+    2,                       // Priority (above loop, so the FIFO empties mid-pass)
+    &drainTask,              // Task handle
+    1                        // Core ID
+  );
+#endif
+}
+
+void KeyQueue::isr() {
+  TCA8418_event = true;
+#ifndef DESKTOP_EMULATOR
+  if (drainTask) {
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(drainTask, &woken);
+    if (woken) portYIELD_FROM_ISR();
+  }
+#endif
+}
+
+void KeyQueue::task(void* param) {
+#ifndef DESKTOP_EMULATOR
+  KeyQueue* self = static_cast<KeyQueue*>(param);
+  for (;;) {
+    // The timeout catches events that queued while the apps had the keypad
+    // interrupt disabled
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(KB_DRAIN_POLL_MS));
+    self->drain();
+  }
+#else
+  (void)param;
+#endif
+}
+
+void KeyQueue::drain() {
+#ifndef DESKTOP_EMULATOR
+  // The FIFO is 10 deep; the bound stops a stuck bus from spinning here
+  for (int n = 0; n < 10 && keypad.available() > 0; n++) {
+    uint8_t code = keypad.getEvent();
+    uint16_t h = head.load(std::memory_order_relaxed);
+    if ((uint16_t)(h - tail.load(std::memory_order_acquire)) >= KB_QUEUE_LEN) {
+      lost++;  // keep the oldest keys, in order
+      continue;
+    }
+    ring[h % KB_QUEUE_LEN] = code;
+    head.store(h + 1, std::memory_order_release);
+  }
+
+  //  try to clear the IRQ flag
+  //  if there are pending events it is not cleared
+  keypad.writeRegister(TCA8418_REG_INT_STAT, 1);
+  int intstat = keypad.readRegister(TCA8418_REG_INT_STAT);
+  if ((intstat & 0x01) == 0) TCA8418_event = false;
+#endif
+}
+
+bool KeyQueue::pop(uint8_t& code) {
+#ifndef DESKTOP_EMULATOR
+  if (!drainTask && TCA8418_event) drain();
+#endif
+  uint16_t t = tail.load(std::memory_order_relaxed);
+  if (t == head.load(std::memory_order_acquire)) return false;
+  code = ring[t % KB_QUEUE_LEN];
+  tail.store(t + 1, std::memory_order_release);
+  return true;
+}
+
+size_t KeyQueue::pending() const {
+  return (uint16_t)(head.load(std::memory_order_acquire) - tail.load(std::memory_order_relaxed));
+}
+
+void KeyQueue::clear() {
+  tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+}
@@ -7,6 +7,242 @@
 std::vector<std::pair<String, String>> defList;
 int definitionIndex = 0;
 
+// DICTIONARY INDEX
+// Each /dict/X.txt gets a sidecar /dict/X.idx:
+//   "LXI1" | dict size | dict mtime | count | count x line offset (uint32 LE)
+// The offsets are ordered by lowercased headword, so a lookup is a binary
+// search that seeks into the dictionary to compare keys.
+#define LEX_INDEX_MAGIC   "LXI1"
+#define LEX_INDEX_HEADER  16
+#define LEX_CACHE_SIZE    8
+#define LEX_INDEX_CHUNK   256   // keys held in RAM while building an index
+
+struct LexCacheEntry {
+  String word;
+  std::vector<std::pair<String, String>> defs;
+  int lastUsed = 0;
+};
+static std::vector<LexCacheEntry> lexCache;
+static int lexCacheCounter = 0;
+
+static void writeU32(File& f, uint32_t v) {
+  uint8_t b[4] = {(uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16), (uint8_t)(v >> 24)};
+  f.write(b, 4);
+}
+
+static uint32_t readU32(File& f) {
+  uint32_t v = 0;
+  for (int i = 0; i < 4; i++) v |= (uint32_t)(f.read() & 0xFF) << (8 * i);
+  return v;
+}
+
+// Splits a dictionary line into "Word (pos.)" and its definition
+static bool splitDefinition(String line, String& key, String& def) {
+  line.trim();
+  int defSplit = line.indexOf(')');
+  if (line.length() == 0 || defSplit == -1) return false;
+  key = line.substring(0, defSplit + 1);
+  def = line.substring(defSplit + 1);
+  def.trim();
+  return true;
+}
+
+static String keyAt(File& dict, uint32_t offset) {
+  dict.seek(offset);
+  String key, def;
+  if (!splitDefinition(dict.readStringUntil('\n'), key, def)) return "";
+  key.toLowerCase();
+  return key;
+}
+
+static bool indexIsCurrent(const String& idxPath, File& dict) {
+  File idx = SD_MMC.open(idxPath);
+  if (!idx) return false;
+
+  char magic[4];
+  for (int i = 0; i < 4; i++) magic[i] = idx.read();
+  bool ok = memcmp(magic, LEX_INDEX_MAGIC, 4) == 0 &&
+            readU32(idx) == (uint32_t)dict.size() &&
+            readU32(idx) == (uint32_t)dict.getLastWrite();
+  if (ok) {
+    uint32_t count = readU32(idx);
+    ok = idx.size() == LEX_INDEX_HEADER + count * 4;
+  }
+  idx.close();
+  return ok;
+}
+
+// Writes one sorted chunk of (key, offset) pairs to the run file. A chunk
+// that starts at or after the previous run's last key just extends that run,
+// so an already-ordered dictionary ends up as a single run.
+static void flushIndexChunk(File& runs, std::vector<std::pair<String, uint32_t>>& chunk,
+                            std::vector<uint32_t>& runStarts, String& runTail, uint32_t& written) {
+  if (chunk.empty()) return;
+  std::stable_sort(chunk.begin(), chunk.end(), [](const std::pair<String, uint32_t>& a, const std::pair<String, uint32_t>& b) {
+    return strcmp(a.first.c_str(), b.first.c_str()) < 0;
+  });
+  if (runStarts.empty() || strcmp(chunk.front().first.c_str(), runTail.c_str()) < 0) {
+    runStarts.push_back(written);
+  }
+  for (auto& entry : chunk) writeU32(runs, entry.second);
+  written += chunk.size();
+  runTail = chunk.back().first;
+  chunk.clear();
+}
+
+static bool indexFailed(const String& idxPath, const String& runPath) {
+  Serial.println("Failed to write dictionary index");
+  if (SD_MMC.exists(runPath)) SD_MMC.remove(runPath);
+  if (SD_MMC.exists(idxPath)) SD_MMC.remove(idxPath);
+  oledWord("Index Failed!");
+  delay(2000);
+  return false;
+}
+
+// External merge sort: the dictionary is scanned in chunks of at most
+// LEX_INDEX_CHUNK keys, each chunk is sorted and spilled to a run file on SD,
+// and the runs are merged into the index holding one key per run in RAM.
+static bool buildIndex(const String& idxPath, File& dict) {
+  oledWord("Indexing Dictionary");
+
+  String runPath = idxPath.substring(0, idxPath.length() - 4) + ".run";
+  if (SD_MMC.exists(runPath)) SD_MMC.remove(runPath);
+  File runs = SD_MMC.open(runPath, FILE_WRITE);
+  if (!runs) return indexFailed(idxPath, runPath);
+
+  std::vector<std::pair<String, uint32_t>> chunk;
+  chunk.reserve(LEX_INDEX_CHUNK);
+  std::vector<uint32_t> runStarts;
+  String runTail = "";
+  uint32_t count = 0;
+  uint32_t offset = 0;
+
+  dict.seek(0);
+  while (dict.available()) {
+    String line = dict.readStringUntil('\n');
+    uint32_t lineStart = offset;
+    offset += line.length() + 1;
+
+    String key, def;
+    if (!splitDefinition(line, key, def)) continue;
+    key.toLowerCase();
+
+    chunk.push_back({key, lineStart});
+    if (chunk.size() >= LEX_INDEX_CHUNK) flushIndexChunk(runs, chunk, runStarts, runTail, count);
+  }
+  flushIndexChunk(runs, chunk, runStarts, runTail, count);
+  std::vector<std::pair<String, uint32_t>>().swap(chunk);
+  runs.close();
+
+  if (SD_MMC.exists(idxPath)) SD_MMC.remove(idxPath);
+  File idx = SD_MMC.open(idxPath, FILE_WRITE);
+  runs = SD_MMC.open(runPath);
+  if (!idx || !runs) {
+    if (idx) idx.close();
+    if (runs) runs.close();
+    return indexFailed(idxPath, runPath);
+  }
+  idx.write((const uint8_t*)LEX_INDEX_MAGIC, 4);
+  writeU32(idx, dict.size());
+  writeU32(idx, dict.getLastWrite());
+  writeU32(idx, count);
+
+  // K-way merge; ties go to the earlier run so equal headwords keep file order
+  struct Run { uint32_t next, end, offset; String key; };
+  std::vector<Run> heads;
+  for (size_t r = 0; r < runStarts.size(); r++) {
+    uint32_t end = (r + 1 < runStarts.size()) ? runStarts[r + 1] : count;
+    heads.push_back({runStarts[r], end, 0, ""});
+  }
+  auto advance = [&](Run& run) {
+    runs.seek(run.next * 4);
+    run.offset = readU32(runs);
+    run.key = keyAt(dict, run.offset);
+    run.next++;
+  };
+  for (auto& run : heads) advance(run);
+
+  uint32_t merged = 0;
+  while (!heads.empty()) {
+    size_t best = 0;
+    for (size_t r = 1; r < heads.size(); r++) {
+      if (strcmp(heads[r].key.c_str(), heads[best].key.c_str()) < 0) best = r;
+    }
+    writeU32(idx, heads[best].offset);
+    merged++;
+    if (heads[best].next < heads[best].end) advance(heads[best]);
+    else heads.erase(heads.begin() + best);
+  }
+  runs.close();
+  idx.close();
+  SD_MMC.remove(runPath);
+
+  if (merged != count) return indexFailed(idxPath, runPath);
+  return true;
+}
+
+// Fills defList with every entry whose headword starts with word, false if
+// the index could not be read
+static bool lookupDefinitions(File& dict, const String& idxPath, const String& word) {
+  File idx = SD_MMC.open(idxPath);
+  if (!idx) return false;
+  idx.seek(12);
+  uint32_t count = readU32(idx);
+
+  // Lower bound: first headword >= word
+  uint32_t lo = 0, hi = count;
+  while (lo < hi) {
+    uint32_t mid = (lo + hi) / 2;
+    idx.seek(LEX_INDEX_HEADER + mid * 4);
+    String key = keyAt(dict, readU32(idx));
+    if (strcmp(key.c_str(), word.c_str()) < 0) lo = mid + 1;
+    else hi = mid;
+  }
+
+  for (uint32_t i = lo; i < count; i++) {
+    idx.seek(LEX_INDEX_HEADER + i * 4);
+    dict.seek(readU32(idx));
+    String key, def;
+    if (!splitDefinition(dict.readStringUntil('\n'), key, def)) break;
+    String keyLower = key;
+    keyLower.toLowerCase();
+    if (!keyLower.startsWith(word)) break;
+    defList.push_back({key, def});
+  }
+  idx.close();
+  return true;
+}
+
+static bool cachedDefinitions(const String& word) {
+  for (auto& entry : lexCache) {
+    if (entry.word.length() > 0 && entry.word == word) {
+      entry.lastUsed = ++lexCacheCounter;
+      defList = entry.defs;
+      return true;
+    }
+  }
+  return false;
+}
+
+// The dictionary for letter changed, its cached lookups may be stale
+static void forgetDefinitions(char letter) {
+  for (auto& entry : lexCache) {
+    if (entry.word.length() > 0 && entry.word[0] == letter) entry.word = "";
+  }
+}
+
+static void cacheDefinitions(const String& word) {
+  if (lexCache.size() < LEX_CACHE_SIZE) lexCache.resize(lexCache.size() + 1);
+  LexCacheEntry* slot = &lexCache[0];
+  for (auto& entry : lexCache) {
+    if (entry.word.length() == 0) { slot = &entry; break; }
+    if (entry.lastUsed < slot->lastUsed) slot = &entry;
+  }
+  slot->word = word;
+  slot->defs = defList;
+  slot->lastUsed = ++lexCacheCounter;
+}
+
 void LEXICON_INIT() {
   // OPEN SETTINGS
   currentLine = "";
@@ -18,11 +254,6 @@ void LEXICON_INIT() {
 }
 
 void loadDefinitions(String word) {
-  oledWord("Loading Definitions");
-  SDActive = true;
-  setCpuFrequencyMhz(240);
-  delay(50);
-
   defList.clear();  // Clear previous results
 
   if (word.length() == 0 || noSD) return;
@@ -30,44 +261,37 @@ void loadDefinitions(String word) {
   char firstChar = tolower(word[0]);
   if (firstChar < 'a' || firstChar > 'z') return;
 
-  String filePath = "/dict/" + String((char)toupper(firstChar)) + ".txt";
-
-  File file = SD_MMC.open(filePath);
-  if (!file) {
-    oledWord("Missing Dictionary!");
-    delay(2000);
-    return;
-  }
-
   word.toLowerCase();
 
-  while (file.available()) {
-    String line = file.readStringUntil('\n');
-    line.trim();
-    if (line.length() == 0) continue;
-
-    int defSplit = line.indexOf(')');
-    if (defSplit == -1) continue;
+  {
+    IoBoostSession ioBoost;
 
-    // Extract key and definition
-    String key = line.substring(0, defSplit + 1);
-    String def = line.substring(defSplit + 1);
-    def.trim();
+    String filePath = "/dict/" + String((char)toupper(firstChar)) + ".txt";
+    String idxPath  = "/dict/" + String((char)toupper(firstChar)) + ".idx";
 
-    String keyLower = key;
-    keyLower.toLowerCase();
+    File file = SD_MMC.open(filePath);
+    if (!file) {
+      oledWord("Missing Dictionary!");
+      delay(2000);
+      return;
+    }
 
-    if (keyLower.startsWith(word)) {
-      defList.push_back({key, def});
+    // A dictionary replaced on the card invalidates what was cached from it
+    bool indexed = indexIsCurrent(idxPath, file);
+    if (!indexed) {
+      forgetDefinitions(firstChar);
+      indexed = buildIndex(idxPath, file);
     }
-    else if (defList.size() > 0) {
-      // No more definitions
-      break;
+
+    // Only a lookup that ran is cached, a failed index build is retried next time
+    if (indexed && !cachedDefinitions(word)) {
+      oledWord("Loading Definitions");
+      if (lookupDefinitions(file, idxPath, word)) cacheDefinitions(word);
     }
+    file.close();
+    if (!indexed) return;
   }
 
-  file.close();
-
   if (defList.empty()) {
     oledWord("No definitions found");
     delay(2000);
@@ -78,9 +302,6 @@ void loadDefinitions(String word) {
     definitionIndex = 0;
     newState = true;
   }
-
-  if (SAVE_POWER) setCpuFrequencyMhz(POWER_SAVE_FREQ);
-  SDActive = false;
 }
 
 void processKB_LEXICON() {
@@ -224,8 +445,7 @@ void processKB_LEXICON() {
 void einkHandler_LEXICON() {
   switch (CurrentLexState) {
     case MENU:
-      if (newState) {
-        newState = false;
+      if (newState.take()) {
 
         display.fillScreen(GxEPD_WHITE);
         display.drawBitmap(0, 0, _lex0, 320, 218, GxEPD_BLACK);
@@ -236,8 +456,7 @@ void einkHandler_LEXICON() {
       }
       break;
     case DEF:
-      if (newState) {
-        newState = false;
+      if (newState.take()) {
 
         display.fillScreen(GxEPD_WHITE);
         display.drawBitmap(0, 0, _lex1, 320, 218, GxEPD_BLACK);
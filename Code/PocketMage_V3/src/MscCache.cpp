@@ -0,0 +1,142 @@
+#include "globals.h"
+
+static bool overlaps(uint32_t a, uint32_t aCount, uint32_t b, uint32_t bCount) {
+  return a < b + bCount && b < a + aCount;
+}
+
+bool MscCache::begin(BlockDevice* device) {
+  std::lock_guard<std::mutex> guard(lock);
+  releaseLocked();  // begin() again without end() keeps no old buffers
+  dev = device;
+  secSize = dev->sectorSize();
+  if (secSize == 0) {
+    dev = nullptr;
+    return false;
+  }
+
+  // Without the buffers every request simply goes straight to the card
+  ahead   = dev->allocBuffer(MSC_READ_AHEAD_SECTORS * secSize);
+  pending = dev->allocBuffer(MSC_WRITE_COALESCE_SECTORS * secSize);
+  if (!ahead || !pending) Serial.println("MSC cache buffers unavailable, running uncached");
+
+  aheadCount   = 0;
+  pendingCount = 0;
+  nextReadLba  = UINT32_MAX;
+  writeFailed  = false;
+  return true;
+}
+
+void MscCache::end() {
+  std::lock_guard<std::mutex> guard(lock);
+  releaseLocked();
+}
+
+void MscCache::releaseLocked() {
+  if (!dev) return;
+  if (!flushLocked()) Serial.println("MSC cache dropped unwritten sectors");
+  if (ahead)   dev->freeBuffer(ahead);
+  if (pending) dev->freeBuffer(pending);
+  ahead = pending = nullptr;
+  aheadCount = pendingCount = 0;
+  dev = nullptr;
+}
+
+int32_t MscCache::read(uint32_t lba, uint8_t* dst, uint32_t bytes) {
+  std::lock_guard<std::mutex> guard(lock);
+  if (!dev) return -1;
+  if (writeFailed) {
+    writeFailed = false;
+    return -1;
+  }
+  uint32_t count = bytes / secSize;
+
+  // Coalesced writes reach the card before the same sectors are read back
+  if (pendingCount && overlaps(lba, count, pendingLba, pendingCount) && !flushLocked()) return -1;
+
+  if (aheadCount && lba >= aheadLba && lba + count <= aheadLba + aheadCount) {
+    memcpy(dst, ahead + (lba - aheadLba) * secSize, bytes);
+    nextReadLba = lba + count;
+    return bytes;
+  }
+
+  // Sequential read, fetch a whole window in one transfer
+  if (ahead && lba == nextReadLba && count < MSC_READ_AHEAD_SECTORS) {
+    uint32_t n = std::min<uint32_t>(MSC_READ_AHEAD_SECTORS, dev->sectorCount() - lba);
+    if (n >= count) {
+      if (pendingCount && overlaps(lba, n, pendingLba, pendingCount) && !flushLocked()) return -1;
+      aheadCount = 0;
+      if (dev->readSectors(ahead, lba, n)) {
+        aheadLba   = lba;
+        aheadCount = n;
+        memcpy(dst, ahead, bytes);
+        nextReadLba = lba + count;
+        return bytes;
+      }
+    }
+  }
+
+  if (!dev->readSectors(dst, lba, count)) return -1;
+  nextReadLba = lba + count;
+  return bytes;
+}
+
+int32_t MscCache::write(uint32_t lba, const uint8_t* src, uint32_t bytes) {
+  std::lock_guard<std::mutex> guard(lock);
+  if (!dev) return -1;
+  if (writeFailed) {
+    writeFailed = false;
+    return -1;
+  }
+  uint32_t count = bytes / secSize;
+
+  // Read-ahead sectors the host is overwriting are stale now
+  if (aheadCount && overlaps(lba, count, aheadLba, aheadCount)) aheadCount = 0;
+
+  if (pendingCount && lba == pendingLba + pendingCount && pendingCount + count <= MSC_WRITE_COALESCE_SECTORS) {
+    memcpy(pending + pendingCount * secSize, src, bytes);
+    pendingCount += count;
+  }
+  else {
+    if (!flushLocked()) return -1;
+    if (!pending || count >= MSC_WRITE_COALESCE_SECTORS) {
+      if (!dev->writeSectors(src, lba, count)) return -1;
+    }
+    else {
+      memcpy(pending, src, bytes);
+      pendingLba   = lba;
+      pendingCount = count;
+    }
+  }
+
+  lastWrite = millis();
+  if (pendingCount == MSC_WRITE_COALESCE_SECTORS && !flushLocked()) return -1;
+  return bytes;
+}
+
+// On failure the sectors stay buffered for the next attempt
+bool MscCache::flushLocked() {
+  if (pendingCount == 0) return true;
+  if (!dev->writeSectors(pending, pendingLba, pendingCount)) {
+    Serial.println("MSC cache write failed at sector " + String((int)pendingLba));
+    return false;
+  }
+  pendingCount = 0;
+  return true;
+}
+
+bool MscCache::flush() {
+  std::lock_guard<std::mutex> guard(lock);
+  if (!dev) return true;
+  if (flushLocked()) return true;
+  writeFailed = true;
+  return false;
+}
+
+void MscCache::idle() {
+  std::lock_guard<std::mutex> guard(lock);
+  if (dev && pendingCount && millis() - lastWrite >= MSC_FLUSH_MS && !flushLocked()) {
+    // The host was told this write succeeded; fail its next request and retry later
+    writeFailed = true;
+    lastWrite = millis();
+  }
+}
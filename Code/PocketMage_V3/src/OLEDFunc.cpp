@@ -6,12 +6,82 @@
 //  `88b    d88'  888       o  888       o  888     d88'  //
 //   `Y8bood8P'  o888ooooood8 o888ooooood8 o888bood8P'    //     
 #include "globals.h"
+#include "GlyphAdvance.h"
 
 #ifdef DESKTOP_EMULATOR
 extern "C" {
   void oled_set_lines(const char* line1, const char* line2, const char* line3);
 }
 #endif
+
+// WIDTH CACHE
+// oledWord() tries font after font and oledLine() measures the same line on
+// every frame, so widths are remembered per font and string. Entries are
+// keyed by a hash of the text; a collision only misplaces one draw.
+struct WidthEntry {
+  const uint8_t* font;
+  uint32_t       hash;
+  uint16_t       length;
+  uint16_t       width;
+};
+static WidthEntry widthCache[OLED_WIDTH_CACHE];
+
+static uint16_t oledStrWidth(const char* str) {
+  const uint8_t* font = u8g2.getU8g2()->font;
+  uint32_t hash = 2166136261u;  // FNV-1a
+  uint16_t length = 0;
+  for (const char* c = str; *c; c++, length++) hash = (hash ^ (uint8_t)*c) * 16777619u;
+
+  WidthEntry& e = widthCache[(hash ^ (uint32_t)(uintptr_t)font) % OLED_WIDTH_CACHE];
+  if (e.font != font || e.hash != hash || e.length != length) {
+    e.font   = font;
+    e.hash   = hash;
+    e.length = length;
+    e.width  = u8g2.getStrWidth(str);
+  }
+  return e.width;
+}
+
+// TILE FLUSH
+// Keeps a copy of what the panel shows and sends only the 8x8 tiles that
+// changed, instead of the whole 256x32 buffer. Dirty runs on a tile row
+// that are close together go out as one area to save the window commands.
+static std::vector<uint8_t> shownTiles;
+
+void oledPresent() {
+  uint8_t* buf = u8g2.getBufferPtr();
+  uint8_t  tilesW = u8g2.getBufferTileWidth();
+  uint8_t  tilesH = u8g2.getBufferTileHeight();
+  size_t   bytes = (size_t)tilesW * tilesH * 8;
+
+  if (shownTiles.size() != bytes) {
+    u8g2.sendBuffer();
+    shownTiles.assign(buf, buf + bytes);
+    return;
+  }
+
+  for (uint8_t ty = 0; ty < tilesH; ty++) {
+    int runStart = -1;
+    int runEnd = -1;
+    for (uint8_t tx = 0; tx <= tilesW; tx++) {
+      bool dirty = false;
+      if (tx < tilesW) {
+        size_t at = ((size_t)ty * tilesW + tx) * 8;
+        dirty = memcmp(buf + at, shownTiles.data() + at, 8) != 0;
+      }
+      if (dirty) {
+        if (runStart < 0) runStart = tx;
+        runEnd = tx;
+      }
+      // Flush the run at the end of the row or once the gap is too wide
+      else if (runStart >= 0 && (tx == tilesW || tx - runEnd > OLED_TILE_MERGE_GAP)) {
+        u8g2.updateDisplayArea(runStart, ty, runEnd - runStart + 1, 1);
+        runStart = -1;
+      }
+    }
+  }
+  memcpy(shownTiles.data(), buf, bytes);
+}
                                                      
 void oledWord(String word, bool allowLarge, bool showInfo) {
   u8g2.clearBuffer();
@@ -20,56 +90,56 @@ void oledWord(String word, bool allowLarge, bool showInfo) {
 
   if (allowLarge) {
     /*u8g2.setFont(u8g2_font_ncenB24_tr);
-    if (u8g2.getStrWidth(word.c_str()) < u8g2.getDisplayWidth()) {
-      u8g2.drawStr((u8g2.getDisplayWidth() - u8g2.getStrWidth(word.c_str()))/2,16+12,word.c_str());
-      u8g2.sendBuffer();
+    if (oledStrWidth(word.c_str()) < u8g2.getDisplayWidth()) {
+      u8g2.drawStr((u8g2.getDisplayWidth() - oledStrWidth(word.c_str()))/2,16+12,word.c_str());
+      oledPresent();
       return;
     }*/
 
     u8g2.setFont(u8g2_font_ncenB18_tr);
-    if (u8g2.getStrWidth(word.c_str()) < u8g2.getDisplayWidth()) {
-      u8g2.drawStr((u8g2.getDisplayWidth() - u8g2.getStrWidth(word.c_str()))/2,16+9,word.c_str());
-      u8g2.sendBuffer();
+    if (oledStrWidth(word.c_str()) < u8g2.getDisplayWidth()) {
+      u8g2.drawStr((u8g2.getDisplayWidth() - oledStrWidth(word.c_str()))/2,16+9,word.c_str());
+      oledPresent();
       return;
     }
   }
 
   u8g2.setFont(u8g2_font_ncenB14_tr);
-  if (u8g2.getStrWidth(word.c_str()) < u8g2.getDisplayWidth()) {
-    u8g2.drawStr((u8g2.getDisplayWidth() - u8g2.getStrWidth(word.c_str()))/2,16+7,word.c_str());
-    u8g2.sendBuffer();
+  if (oledStrWidth(word.c_str()) < u8g2.getDisplayWidth()) {
+    u8g2.drawStr((u8g2.getDisplayWidth() - oledStrWidth(word.c_str()))/2,16+7,word.c_str());
+    oledPresent();
     return;
   }
 
   u8g2.setFont(u8g2_font_ncenB12_tr);
-  if (u8g2.getStrWidth(word.c_str()) < u8g2.getDisplayWidth()) {
-    u8g2.drawStr((u8g2.getDisplayWidth() - u8g2.getStrWidth(word.c_str()))/2,16+6,word.c_str());
-    u8g2.sendBuffer();
+  if (oledStrWidth(word.c_str()) < u8g2.getDisplayWidth()) {
+    u8g2.drawStr((u8g2.getDisplayWidth() - oledStrWidth(word.c_str()))/2,16+6,word.c_str());
+    oledPresent();
     return;
   }
 
   u8g2.setFont(u8g2_font_ncenB10_tr);
-  if (u8g2.getStrWidth(word.c_str()) < u8g2.getDisplayWidth()) {
-    u8g2.drawStr((u8g2.getDisplayWidth() - u8g2.getStrWidth(word.c_str()))/2,16+5,word.c_str());
-    u8g2.sendBuffer();
+  if (oledStrWidth(word.c_str()) < u8g2.getDisplayWidth()) {
+    u8g2.drawStr((u8g2.getDisplayWidth() - oledStrWidth(word.c_str()))/2,16+5,word.c_str());
+    oledPresent();
     return;
   }
 
   u8g2.setFont(u8g2_font_ncenB08_tr);
-  if (u8g2.getStrWidth(word.c_str()) < u8g2.getDisplayWidth()) {
-    u8g2.drawStr((u8g2.getDisplayWidth() - u8g2.getStrWidth(word.c_str()))/2,16+4,word.c_str());
-    u8g2.sendBuffer();
+  if (oledStrWidth(word.c_str()) < u8g2.getDisplayWidth()) {
+    u8g2.drawStr((u8g2.getDisplayWidth() - oledStrWidth(word.c_str()))/2,16+4,word.c_str());
+    oledPresent();
     return;
   }
   else {
-    u8g2.drawStr(u8g2.getDisplayWidth() - u8g2.getStrWidth(word.c_str()),16+4,word.c_str());
-    u8g2.sendBuffer();
+    u8g2.drawStr(u8g2.getDisplayWidth() - oledStrWidth(word.c_str()),16+4,word.c_str());
+    oledPresent();
     return;
   }
   
 }
 
-void oledLine(String line, bool doProgressBar, String bottomMsg) {
+void oledLine(String line, bool doProgressBar, String bottomMsg, int cursorPos) {
   uint8_t maxLength = maxCharsPerLine;
   u8g2.clearBuffer();
   
@@ -77,9 +147,7 @@ void oledLine(String line, bool doProgressBar, String bottomMsg) {
   if (doProgressBar && line.length() > 0) {
     //uint8_t progress = map(line.length(), 0, maxLength, 0, 128);
 
-    int16_t x1, y1;
-    uint16_t charWidth, charHeight;
-    display.getTextBounds(line, 0, 0, &x1, &y1, &charWidth, &charHeight);
+    uint16_t charWidth = glyphAdvance(currentFont).measure(line);
 
     uint8_t progress = map(charWidth, 0, display.width()-5, 0, u8g2.getDisplayWidth());
 
@@ -110,26 +178,34 @@ void oledLine(String line, bool doProgressBar, String bottomMsg) {
     u8g2.setFont(u8g2_font_5x7_tf);
     switch (CurrentKBState) {
       case SHIFT:
-        u8g2.drawStr((u8g2.getDisplayWidth() - u8g2.getStrWidth("SHIFT")), u8g2.getDisplayHeight(), "SHIFT");
+        u8g2.drawStr((u8g2.getDisplayWidth() - oledStrWidth("SHIFT")), u8g2.getDisplayHeight(), "SHIFT");
         break;
       case FUNC:
-        u8g2.drawStr((u8g2.getDisplayWidth() - u8g2.getStrWidth("FN")), u8g2.getDisplayHeight(), "FN");
+        u8g2.drawStr((u8g2.getDisplayWidth() - oledStrWidth("FN")), u8g2.getDisplayHeight(), "FN");
         break;
     }
   }
 
   // DRAW LINE TEXT
   u8g2.setFont(u8g2_font_ncenB18_tr);
-  if (u8g2.getStrWidth(line.c_str()) < (u8g2.getDisplayWidth() - 5)) {
+  int lineWidth = oledStrWidth(line.c_str());
+  // Caret goes at cursorPos, or after the text when no cursor is given
+  bool hasCursor = (cursorPos >= 0 && cursorPos < (int)line.length());
+  int caretX = hasCursor ? oledStrWidth(line.substring(0, cursorPos).c_str()) : lineWidth;
+
+  if (lineWidth < (u8g2.getDisplayWidth() - 5)) {
     u8g2.drawStr(0,20,line.c_str());
-    if (line.length() > 0) u8g2.drawVLine(u8g2.getStrWidth(line.c_str()) + 2, 1, 22);
+    if (line.length() > 0 || cursorPos >= 0) u8g2.drawVLine(caretX + 2, 1, 22);
   }
   // Draw position indicator
   else {
-    u8g2.drawStr(u8g2.getDisplayWidth()-8-u8g2.getStrWidth(line.c_str()),20,line.c_str());
+    int x = u8g2.getDisplayWidth()-8-lineWidth;
+    if (x + caretX < 0) x = 4 - caretX;  // Keep the caret on screen
+    u8g2.drawStr(x,20,line.c_str());
+    if (hasCursor) u8g2.drawVLine(x + caretX + 1, 1, 22);
   }
 
-  u8g2.sendBuffer();
+  oledPresent();
 }
 
 void infoBar() {
@@ -137,10 +213,10 @@ void infoBar() {
   u8g2.setFont(u8g2_font_5x7_tf);
   switch (CurrentKBState) {
     case SHIFT:
-      u8g2.drawStr((u8g2.getDisplayWidth() - u8g2.getStrWidth("SHIFT")) / 2, u8g2.getDisplayHeight(), "SHIFT");
+      u8g2.drawStr((u8g2.getDisplayWidth() - oledStrWidth("SHIFT")) / 2, u8g2.getDisplayHeight(), "SHIFT");
       break;
     case FUNC:
-      u8g2.drawStr((u8g2.getDisplayWidth() - u8g2.getStrWidth("FN")) / 2, u8g2.getDisplayHeight(), "FN");
+      u8g2.drawStr((u8g2.getDisplayWidth() - oledStrWidth("FN")) / 2, u8g2.getDisplayHeight(), "FN");
       break;
   }
 
@@ -152,19 +228,26 @@ void infoBar() {
   // CLOCK
   if (SYSTEM_CLOCK) {
     u8g2.setFont(u8g2_font_5x7_tf);
-    DateTime now = rtc.now();
-    String timeString = "";
-    timeString += String(now.hour());
-    timeString += ":";
-    if (now.minute() < 10) timeString += ("0"+String(now.minute()));
-    else timeString += String(now.minute());
+    // The strings are only rebuilt when the shown minute changes
+    static uint32_t shownMinute = UINT32_MAX;
+    static bool     shownYear = false;
+    static String   timeString;
+    static String   day3Char;
+    if (timeService.minuteChanged(shownMinute) || shownYear != SHOW_YEAR) {
+      shownYear = SHOW_YEAR;
+      DateTime now = timeService.now();
+      timeString = String(now.hour());
+      timeString += ":";
+      if (now.minute() < 10) timeString += ("0"+String(now.minute()));
+      else timeString += String(now.minute());
+      day3Char = String(daysOfTheWeek[now.dayOfTheWeek()]).substring(0, 3);
+      if (SHOW_YEAR) day3Char += (" "+String(now.month())+"/"+String(now.day())+"/"+String(now.year()).substring(2,4)); 
+      else           day3Char += (" "+String(now.month())+"/"+String(now.day())); 
+    }
     u8g2.drawStr(infoWidth,u8g2.getDisplayHeight(),timeString.c_str());
-    String day3Char = String(daysOfTheWeek[now.dayOfTheWeek()]).substring(0, 3);
-    if (SHOW_YEAR) day3Char += (" "+String(now.month())+"/"+String(now.day())+"/"+String(now.year()).substring(2,4)); 
-    else           day3Char += (" "+String(now.month())+"/"+String(now.day())); 
-    u8g2.drawStr(u8g2.getDisplayWidth() - u8g2.getStrWidth(day3Char.c_str()), u8g2.getDisplayHeight(), day3Char.c_str());    
+    u8g2.drawStr(u8g2.getDisplayWidth() - oledStrWidth(day3Char.c_str()), u8g2.getDisplayHeight(), day3Char.c_str());    
     
-    infoWidth += (u8g2.getStrWidth(timeString.c_str()) + 6);
+    infoWidth += (oledStrWidth(timeString.c_str()) + 6);
   }
 
   // MSC Indicator
@@ -172,7 +255,7 @@ void infoBar() {
     u8g2.setFont(u8g2_font_5x7_tf);
     u8g2.drawStr(infoWidth,u8g2.getDisplayHeight(),"USB");
 
-    infoWidth += (u8g2.getStrWidth("USB") + 6);
+    infoWidth += (oledStrWidth("USB") + 6);
   }
 
   // SD Indicator
@@ -180,7 +263,7 @@ void infoBar() {
     u8g2.setFont(u8g2_font_5x7_tf);
     u8g2.drawStr(infoWidth,u8g2.getDisplayHeight(),"SD");
 
-    infoWidth += (u8g2.getStrWidth("SD") + 6);
+    infoWidth += (oledStrWidth("SD") + 6);
   }
 }
 
@@ -199,12 +282,9 @@ void oledScroll() {
   for (long int i = startIndex; i > endIndex && i >= 0; i--) {
     if (i >= count) continue;  // Ensure i is within bounds
 
-    int16_t x1, y1;
-    uint16_t charWidth, charHeight;
-
     // CHECK IF LINE STARTS WITH A TAB
     if (allLines[i].startsWith("    ")) {
-      display.getTextBounds(allLines[i].substring(4), 0, 0, &x1, &y1, &charWidth, &charHeight);
+      uint16_t charWidth = glyphAdvance(currentFont).measure(allLines[i], 4, allLines[i].length());
       int lineWidth = map(charWidth, 0, 320, 0, 49);
 
       lineWidth = constrain(lineWidth, 0, 49);
@@ -212,7 +292,7 @@ void oledScroll() {
       u8g2.drawBox(68, 28 - (4 * (startIndex - i)), lineWidth, 2);
     }
     else {
-      display.getTextBounds(allLines[i], 0, 0, &x1, &y1, &charWidth, &charHeight);
+      uint16_t charWidth = glyphAdvance(currentFont).measure(allLines[i]);
       int lineWidth = map(charWidth, 0, 320, 0, 56);
 
       lineWidth = constrain(lineWidth, 0, 56);
@@ -238,5 +318,5 @@ void oledScroll() {
   }
 
   // SEND BUFFER 
-  u8g2.sendBuffer();
+  oledPresent();
 }
\ No newline at end of file
@@ -504,7 +504,7 @@ static void update_oled() {
     u8g2.drawStr(0, 8, "Periodic Table");
     u8g2.drawStr(0, 16, "Arrows: Navigate");
     u8g2.drawStr(0, 24, "Enter: Details");
-    u8g2.sendBuffer();
+    oledPresent();
 #endif
     return;
   }
@@ -537,7 +537,7 @@ static void update_oled() {
   u8g2.drawStr(0, 8, line1);
   u8g2.drawStr(0, 16, line2);
   u8g2.drawStr(0, 24, line3);
-  u8g2.sendBuffer();
+  oledPresent();
 #endif
 }
 
@@ -641,7 +641,7 @@ void processKB_PERIODIC() {
       oled_set_lines("", "", "");  // Clear OLED display
 #else
       u8g2.clearBuffer();
-      u8g2.sendBuffer();
+      oledPresent();
 #endif
       return;
     }
@@ -708,7 +708,7 @@ void processKB_PERIODIC() {
     oled_set_lines("", "", "");  // Clear OLED display
 #else
     u8g2.clearBuffer();
-    u8g2.sendBuffer();
+    oledPresent();
 #endif
     // CRITICAL: Return immediately to prevent further rendering after app exit
     return;
@@ -727,14 +727,12 @@ void processKB_PERIODIC() {
 void drawPERIODIC() {
   // Skip canvas initialization - use direct rendering only
   
-  if (newState) {
-    newState = false;
+  if (newState.take()) {
     
     if (periodic::in_detail) {
       periodic::paint_detail();
-      if (doFull) {
+      if (doFull.take()) {
         refresh();
-        doFull = false;
       }
     } else {
       periodic::paint_table();
@@ -43,6 +43,7 @@ DexState& getDexStateRef();
 void drawNewPokemonList();
 void drawNewPokemonDetail();
 void drawNewSearchScreen();
+static void queueSpritePrefetch(const DexState& state);
 void handleNewPokedexNavigation(char key);
 DexView getCurrentDexView();
 const DexState& getDexState();
@@ -482,7 +483,7 @@ void processKB_POKEDEX() {
         refresh();
         
         u8g2.clearBuffer();
-        u8g2.sendBuffer();
+        oledPresent();
         
         CurrentAppState = HOME;
         newState = true;
@@ -509,7 +510,10 @@ void einkHandler_POKEDEX() {
   unsigned long now = millis();
   
   // Prevent concurrent rendering and limit update frequency to prevent Metal conflicts
-  if (rendering || now - lastEinkUpdate < 100) return; // Reduced from 1000ms to 100ms
+  if (rendering || now - lastEinkUpdate < 100) { // Reduced from 1000ms to 100ms
+    renderQueue.retryLater();
+    return;
+  }
   
   rendering = true;
   lastEinkUpdate = now;
@@ -519,7 +523,9 @@ void einkHandler_POKEDEX() {
     DexState& state = getDexStateRef();
     
     // Only redraw if something actually changed
-    bool needsRedraw = (currentView != lastView) || (state.selected != lastSelected) || newState;
+    bool stateReq = newState.take();
+    doFull.take();  // every redraw here refreshes the whole panel anyway
+    bool needsRedraw = (currentView != lastView) || (state.selected != lastSelected) || stateReq;
     
     if (needsRedraw) {
       std::cout << "[POKEDEX] einkHandler_POKEDEX() - redrawing due to changes" << std::endl;
@@ -545,11 +551,14 @@ void einkHandler_POKEDEX() {
       // Update tracking variables
       lastView = currentView;
       lastSelected = state.selected;
-      newState = false;
-      doFull = false;
+
+      queueSpritePrefetch(state);
       
       // Minimal delay to prevent encoder issues
       delay(5);
+    } else {
+      // Idle: pull in one neighbor sprite per pass, keep coming back until the queue drains
+      if (getSpriteCache().prefetchStep()) renderQueue.retryLater();
     }
   } catch (...) {
     // Handle any rendering errors silently
@@ -611,7 +620,7 @@ void updatePokedexOLED() {
       break;
   }
   
-  u8g2.sendBuffer();
+  oledPresent();
 }
 
 // New drawing functions that use the graphics adapter
@@ -636,21 +645,22 @@ void drawNewSearchScreen() {
 // Handle navigation with new system
 void handleNewPokedexNavigation(char key) {
   PokedexUI::handleNavigation(getDexStateRef(), key, getPokemonData());
-  
-  // Preload adjacent sprites for smooth navigation
-  DexState& state = getDexStateRef();
-  if (!state.filteredIndex.empty() && state.selected < (int)state.filteredIndex.size()) {
-    uint16_t currentId = getPokemonData()[state.filteredIndex[state.selected]].id;
-    getSpriteCache().preload(currentId);
-    
-    // Preload previous and next
-    if (state.selected > 0) {
-      uint16_t prevId = getPokemonData()[state.filteredIndex[state.selected - 1]].id;
-      getSpriteCache().preload(prevId);
+  // Neighbor sprites are prefetched from einkHandler_POKEDEX while idle
+}
+
+// Queue the sprites around the selection, nearest first
+static void queueSpritePrefetch(const DexState& state) {
+  SpriteCache& cache = getSpriteCache();
+  cache.clearPrefetch();
+  if (state.filteredIndex.empty()) return;
+
+  int count = (int)state.filteredIndex.size();
+  for (int d = 0; d <= POKEDEX_PREFETCH_RADIUS; d++) {
+    if (state.selected + d < count) {
+      cache.queuePrefetch(getPokemonData()[state.filteredIndex[state.selected + d]].id);
     }
-    if (state.selected + 1 < (int)state.filteredIndex.size()) {
-      uint16_t nextId = getPokemonData()[state.filteredIndex[state.selected + 1]].id;
-      getSpriteCache().preload(nextId);
+    if (d > 0 && state.selected - d >= 0) {
+      cache.queuePrefetch(getPokemonData()[state.filteredIndex[state.selected - d]].id);
     }
   }
 }
@@ -0,0 +1,270 @@
+#include "PieceTable.h"
+
+#define PT_NONE ((size_t)-1)
+
+void PieceTable::load(const String& text) {
+  original = text;
+  addBuf = "";
+  nodes.clear();
+  freeNodes.clear();
+  root = -1;
+  totalLength = original.length();
+  if (totalLength > 0) root = newNode({false, 0, (uint32_t)totalLength});
+}
+
+void PieceTable::clear() {
+  load("");
+}
+
+// TREAP
+int32_t PieceTable::newNode(const Piece& p) {
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+  Node n = {p, p.len, seed, -1, -1};
+
+  if (!freeNodes.empty()) {
+    int32_t t = freeNodes.back();
+    freeNodes.pop_back();
+    nodes[t] = n;
+    return t;
+  }
+  nodes.push_back(n);
+  return nodes.size() - 1;
+}
+
+void PieceTable::freeTree(int32_t t) {
+  if (t < 0) return;
+  freeTree(nodes[t].left);
+  freeTree(nodes[t].right);
+  freeNodes.push_back(t);
+}
+
+void PieceTable::pull(int32_t t) {
+  nodes[t].sum = nodes[t].piece.len + sumOf(nodes[t].left) + sumOf(nodes[t].right);
+}
+
+// First pos bytes of t go to l, the rest to r. A piece straddling pos is cut
+// in two.
+void PieceTable::split(int32_t t, size_t pos, int32_t& l, int32_t& r) {
+  if (t < 0) {
+    l = r = -1;
+    return;
+  }
+  size_t leftLen = sumOf(nodes[t].left);
+  size_t end     = leftLen + nodes[t].piece.len;
+
+  if (pos <= leftLen) {
+    int32_t rest;
+    split(nodes[t].left, pos, l, rest);
+    nodes[t].left = rest;
+    r = t;
+  }
+  else if (pos >= end) {
+    int32_t rest;
+    split(nodes[t].right, pos - end, rest, r);
+    nodes[t].right = rest;
+    l = t;
+  }
+  else {
+    Piece tail = nodes[t].piece;
+    uint32_t headLen = pos - leftLen;
+    tail.start += headLen;
+    tail.len   -= headLen;
+    nodes[t].piece.len = headLen;
+
+    int32_t tailNode = newNode(tail);  // may move nodes, index only from here
+    r = merge(tailNode, nodes[t].right);
+    nodes[t].right = -1;
+    l = t;
+  }
+  pull(t);
+}
+
+int32_t PieceTable::merge(int32_t a, int32_t b) {
+  if (a < 0) return b;
+  if (b < 0) return a;
+  if (nodes[a].prio > nodes[b].prio) {
+    int32_t m = merge(nodes[a].right, b);
+    nodes[a].right = m;
+    pull(a);
+    return a;
+  }
+  int32_t m = merge(a, nodes[b].left);
+  nodes[b].left = m;
+  pull(b);
+  return b;
+}
+
+// Node holding pos and the document offset of its piece, -1 at/after the end
+int32_t PieceTable::locate(size_t pos, size_t& pieceStart) const {
+  int32_t t = root;
+  size_t base = 0;
+  while (t >= 0) {
+    size_t leftLen = sumOf(nodes[t].left);
+    if (pos < base + leftLen) {
+      t = nodes[t].left;
+      continue;
+    }
+    size_t start = base + leftLen;
+    if (pos < start + nodes[t].piece.len) {
+      pieceStart = start;
+      return t;
+    }
+    base = start + nodes[t].piece.len;
+    t = nodes[t].right;
+  }
+  return -1;
+}
+
+// EDITING
+void PieceTable::insert(size_t pos, const String& text) {
+  size_t n = text.length();
+  if (n == 0) return;
+  if (pos > totalLength) pos = totalLength;
+
+  // TYPING FAST PATH: extend the add-buffer piece that ends right here
+  if (pos > 0) {
+    size_t start;
+    int32_t t = locate(pos - 1, start);
+    const Piece& p = nodes[t].piece;
+    if (p.added && start + p.len == pos && p.start + p.len == addBuf.length()) {
+      addBuf += text;
+      nodes[t].piece.len += n;
+
+      // Grow the subtree sums on the way back down to it
+      size_t base = 0;
+      for (int32_t u = root; u != t;) {
+        nodes[u].sum += n;
+        size_t leftLen = sumOf(nodes[u].left);
+        if (pos - 1 < base + leftLen) u = nodes[u].left;
+        else {
+          base += leftLen + nodes[u].piece.len;
+          u = nodes[u].right;
+        }
+      }
+      nodes[t].sum += n;
+      totalLength += n;
+      return;
+    }
+  }
+
+  int32_t l, r;
+  split(root, pos, l, r);
+  int32_t t = newNode({true, (uint32_t)addBuf.length(), (uint32_t)n});
+  addBuf += text;
+  root = merge(merge(l, t), r);
+  totalLength += n;
+}
+
+void PieceTable::erase(size_t pos, size_t len) {
+  if (pos >= totalLength || len == 0) return;
+  if (len > totalLength - pos) len = totalLength - pos;
+
+  int32_t l, mid, r;
+  split(root, pos, l, mid);
+  split(mid, len, mid, r);
+  freeTree(mid);
+  root = merge(l, r);
+  totalLength -= len;
+}
+
+// READING
+char PieceTable::charAt(size_t pos) const {
+  size_t start;
+  int32_t t = locate(pos, start);
+  if (t < 0) return 0;
+  const Piece& p = nodes[t].piece;
+  return bufferOf(p)[p.start + (pos - start)];
+}
+
+// Appends [from, to) of subtree t, which starts at document offset base
+void PieceTable::collect(int32_t t, size_t base, size_t from, size_t to, String& out) const {
+  if (t < 0) return;
+  size_t start = base + sumOf(nodes[t].left);
+  size_t end   = start + nodes[t].piece.len;
+
+  if (from < start) collect(nodes[t].left, base, from, to, out);
+  if (from < end && to > start) {
+    const Piece& p = nodes[t].piece;
+    const String& buf = p.added ? addBuf : original;
+    size_t a = std::max(from, start) - start;
+    size_t b = std::min(to, end) - start;
+    out += buf.substring(p.start + a, p.start + b);
+  }
+  if (to > end) collect(nodes[t].right, end, from, to, out);
+}
+
+String PieceTable::substring(size_t start, size_t end) const {
+  String result = "";
+  if (end > totalLength) end = totalLength;
+  if (start >= end) return result;
+  collect(root, 0, start, end, result);
+  return result;
+}
+
+// First '\n' at or after from, PT_NONE if none
+size_t PieceTable::findNewline(int32_t t, size_t base, size_t from) const {
+  if (t < 0) return PT_NONE;
+  size_t start = base + sumOf(nodes[t].left);
+  size_t end   = start + nodes[t].piece.len;
+
+  if (from < start) {
+    size_t found = findNewline(nodes[t].left, base, from);
+    if (found != PT_NONE) return found;
+  }
+  if (from < end) {
+    const Piece& p = nodes[t].piece;
+    const char* buf = bufferOf(p) + p.start;
+    for (size_t off = std::max(from, start) - start; off < p.len; off++) {
+      if (buf[off] == '\n') return start + off;
+    }
+  }
+  return findNewline(nodes[t].right, end, from);
+}
+
+// Last '\n' before offset before, PT_NONE if none
+size_t PieceTable::findNewlineBefore(int32_t t, size_t base, size_t before) const {
+  if (t < 0 || before <= base) return PT_NONE;
+  size_t start = base + sumOf(nodes[t].left);
+  size_t end   = start + nodes[t].piece.len;
+
+  if (before > end) {
+    size_t found = findNewlineBefore(nodes[t].right, end, before);
+    if (found != PT_NONE) return found;
+  }
+  if (before > start) {
+    const Piece& p = nodes[t].piece;
+    const char* buf = bufferOf(p) + p.start;
+    for (size_t off = std::min(before, end) - start; off > 0; off--) {
+      if (buf[off - 1] == '\n') return start + off - 1;
+    }
+  }
+  return findNewlineBefore(nodes[t].left, base, before);
+}
+
+size_t PieceTable::lineStart(size_t pos) const {
+  if (pos > totalLength) pos = totalLength;
+  size_t nl = findNewlineBefore(root, 0, pos);
+  return nl == PT_NONE ? 0 : nl + 1;
+}
+
+size_t PieceTable::lineEnd(size_t pos) const {
+  size_t nl = findNewline(root, 0, pos);
+  return nl == PT_NONE ? totalLength : nl;
+}
+
+size_t PieceTable::prevChar(size_t pos) const {
+  if (pos == 0) return 0;
+  if (pos > totalLength) pos = totalLength;
+  pos--;
+  while (pos > 0 && (charAt(pos) & 0xC0) == 0x80) pos--;
+  return pos;
+}
+
+size_t PieceTable::nextChar(size_t pos) const {
+  if (pos >= totalLength) return totalLength;
+  pos++;
+  while (pos < totalLength && (charAt(pos) & 0xC0) == 0x80) pos++;
+  return pos;
+}
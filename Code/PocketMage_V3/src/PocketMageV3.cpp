@@ -161,6 +161,7 @@ void setup() {
   attachInterrupt(digitalPinToInterrupt(KB_IRQ), TCA8418_irq, CHANGE);
   keypad.flush();
   keypad.enableInterrupts();
+  keyQueue.begin();
 
   // SD CARD SETUP
   SD_MMC.setPins(SD_CLK, SD_CMD, SD_D0);
@@ -186,7 +187,7 @@ void setup() {
     }
   }
 
-  setCpuFrequencyMhz(240);
+  IoBoostSession::boost();
   // Create folders and files if needed
   if (!SD_MMC.exists("/sys"))     SD_MMC.mkdir("/sys");
   if (!SD_MMC.exists("/journal")) SD_MMC.mkdir("/journal");
@@ -199,8 +200,8 @@ void setup() {
     File f = SD_MMC.open("/sys/events.txt", FILE_WRITE);
     if (f) f.close();
   }
-  if (!SD_MMC.exists("/sys/tasks.txt")) {
-    File f = SD_MMC.open("/sys/tasks.txt", FILE_WRITE);
+  if (!SD_MMC.exists(SYS_TASKS_FILE)) {
+    File f = SD_MMC.open(SYS_TASKS_FILE, FILE_WRITE);
     if (f) f.close();
   }
   if (!SD_MMC.exists("/sys/SDMMC_META.txt")) {
@@ -218,7 +219,9 @@ void setup() {
     initializeFallbackLayout();
   }
  
+  ioWorker.begin();
   loadState();
+  prefetchDirIndex();
 
   // EINK HANDLER SETUP
   display.init(115200);
@@ -235,6 +238,7 @@ void setup() {
     &einkHandlerTaskHandle,  // Task handle
     0                        // Core ID (0 for core 0, 1 for core 1)
   );
+  renderQueue.attach(einkHandlerTaskHandle);
 
   // POWER SETUP
   pinMode(PWR_BTN, INPUT_PULLUP);
@@ -245,8 +249,7 @@ void setup() {
   //btStop();
 
   // SET CPU CLOCK FOR POWER SAVE MODE
-  if (SAVE_POWER) setCpuFrequencyMhz(40 );
-  else            setCpuFrequencyMhz(240);
+  IoBoostSession::release();
 
   // MPR121 / SLIDER
   if (!cap.begin(MPR121_ADDR)) {
@@ -254,6 +257,10 @@ void setup() {
     oledWord("TouchPad Failed");
     delay(1000);
   }
+  if (TOUCH_IRQ >= 0) {
+    pinMode(TOUCH_IRQ, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(TOUCH_IRQ), MPR121_irq, FALLING);
+  }
 
   // RTC SETUP
   pinMode(RTC_INT, INPUT);
@@ -265,6 +272,7 @@ void setup() {
   // SET CLOCK IF NEEDED
   if (SET_CLOCK_ON_UPLOAD || rtc.lostPower()) rtc.adjust(DateTime(F(__DATE__), F(__TIME__)));
   rtc.start();
+  timeService.sync();
 
   // Set "random" seed
   randomSeed(analogRead(BAT_SENS));
@@ -276,6 +284,9 @@ void loop() {
 
   updateBattState();
   processKB();
+  ioWorker.poll();
+  sdCache.idle();
+  IoBoostSession::idle();
 
   // Yield to watchdog
   vTaskDelay(50 / portTICK_PERIOD_MS);
@@ -57,8 +57,7 @@ SpriteCache::SpriteCache(int maxEntries) : maxEntries(maxEntries), accessCounter
   cache.resize(maxEntries);
   for (auto& entry : cache) {
     entry.valid = false;
-    entry.data64 = nullptr;
-    entry.data32 = nullptr;
+    entry.id = 0;
     entry.lastUsed = 0;
   }
 }
@@ -69,122 +68,121 @@ void SpriteCache::setLoader(bool (*loaderFunc)(uint16_t, uint8_t*, int, int, int
   spriteLoader = loaderFunc;
 }
 
-void SpriteCache::evictLRU() {
-  // Simple stub - do nothing for now
-}
-
-void SpriteCache::downscale64to32(const uint8_t* src, uint8_t* dst) {
-  // Simple stub - do nothing for now
+SpriteCache::CacheEntry* SpriteCache::find(uint16_t id) {
+  for (auto& entry : cache) {
+    if (entry.valid && entry.id == id) return &entry;
+  }
+  return nullptr;
 }
 
-const uint8_t* SpriteCache::get32(uint16_t id) {
-  // Validate ID range
-  if (id == 0 || id > 151) {  // Gen 1 Pokemon only
-    std::cout << "[CACHE] Invalid Pokemon ID: " << id << std::endl;
-    return nullptr;
-  }
-  
-  // Check if already cached
+// Free slot if there is one, otherwise the least recently used entry
+SpriteCache::CacheEntry& SpriteCache::evictLRU() {
+  CacheEntry* victim = &cache[0];
   for (auto& entry : cache) {
-    if (entry.valid && entry.id == id && entry.data32) {
-      entry.lastUsed = ++accessCounter;
-      return entry.data32;
-    }
-  }
-  
-  // Load actual sprite from pokemon_sprites.bin file (sprites are 64x64)
-  static uint8_t spriteBuffer1bpp[64 * 64 / 8]; // 64x64 1-bit bitmap from file = 512 bytes
-  static uint8_t spriteBuffer4bpp[32 * 32 / 2]; // 32x32 4bpp bitmap for display
-  
-  // Load 64x64 1-bit sprite from binary file
-  extern bool loadPokemonSprite(uint16_t pokemonId, uint8_t* spriteBuffer, size_t bufferSize);
-  if (!loadPokemonSprite(id, spriteBuffer1bpp, sizeof(spriteBuffer1bpp))) {
-    std::cout << "[CACHE] Failed to load sprite for Pokemon " << id << std::endl;
-    return nullptr;
+    if (!entry.valid) return entry;
+    if (entry.lastUsed < victim->lastUsed) victim = &entry;
   }
-  
-  // Downscale from 64x64 to 32x32 and convert 1bpp to 4bpp format
-  memset(spriteBuffer4bpp, 0, sizeof(spriteBuffer4bpp));
-  int stride = (32 + 1) / 2; // Bytes per row in 4bpp format
-  
+  victim->valid = false;
+  return *victim;
+}
+
+// 2x2 box filter: a pixel stays black if at least half of its block is black,
+// which keeps the one pixel outlines that point sampling drops
+void SpriteCache::downscale64to32(const uint8_t* src, uint8_t* dst) {
+  memset(dst, 0xFF, 32 * 32 / 8);
   for (int y = 0; y < 32; y++) {
+    const uint8_t* row0 = src + (y * 2) * 8;
+    const uint8_t* row1 = row0 + 8;
     for (int x = 0; x < 32; x++) {
-      // Sample from 64x64 source (2x2 downscaling)
-      int srcY = y * 2;
-      int srcX = x * 2;
-      int srcByteIndex = (srcY * 64 + srcX) / 8;
-      int srcBitIndex = (srcY * 64 + srcX) % 8;
-      bool pixel = (spriteBuffer1bpp[srcByteIndex] >> (7 - srcBitIndex)) & 1;
-      
-      // Invert the pixel logic - 0 bit = black pixel, 1 bit = white/transparent
-      if (!pixel) {
-        int dstByteIndex = y * stride + x / 2;
-        if (x % 2 == 0) {
-          spriteBuffer4bpp[dstByteIndex] |= 0x0F; // Low nibble - black pixel
-        } else {
-          spriteBuffer4bpp[dstByteIndex] |= 0xF0; // High nibble - black pixel
-        }
+      int sx = x * 2;
+      int shift = 6 - (sx % 8);
+      uint8_t bits = ((row0[sx / 8] >> shift) & 0x3) | (((row1[sx / 8] >> shift) & 0x3) << 2);
+      int black = 4 - __builtin_popcount(bits);
+      if (black >= 2) {
+        dst[y * 4 + x / 8] &= ~(0x80 >> (x % 8));
       }
     }
   }
-  
-  return spriteBuffer4bpp;
 }
 
-const uint8_t* SpriteCache::get64(uint16_t id) {
+// 1bpp (0 = black) to 4bpp, low nibble first, 0xF = black
+void SpriteCache::expand4bpp(const uint8_t* src, int size, uint8_t* dst) {
+  int stride = (size + 1) / 2;
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < size; x += 2) {
+      int bit = y * size + x;
+      uint8_t pair = (src[bit / 8] >> (6 - (bit % 8))) & 0x3;
+      uint8_t out = 0;
+      if (!(pair & 0x2)) out |= 0x0F;
+      if (!(pair & 0x1)) out |= 0xF0;
+      dst[y * stride + x / 2] = out;
+    }
+  }
+}
+
+SpriteCache::CacheEntry* SpriteCache::load(uint16_t id) {
   // Validate ID range
   if (id == 0 || id > 151) {  // Gen 1 Pokemon only
     std::cout << "[CACHE] Invalid Pokemon ID: " << id << std::endl;
     return nullptr;
   }
   
-  // Check if already cached
-  for (auto& entry : cache) {
-    if (entry.valid && entry.id == id && entry.data64) {
-      entry.lastUsed = ++accessCounter;
-      return entry.data64;
-    }
-  }
-  
-  // Load actual sprite from pokemon_sprites.bin file
-  static uint8_t spriteBuffer1bpp[64 * 64 / 8]; // 64x64 1-bit bitmap from file
-  static uint8_t spriteBuffer4bpp[64 * 64 / 2]; // 64x64 4bpp bitmap for display
+  CacheEntry* entry = find(id);
+  if (entry) return entry;
   
-  // Load 1-bit sprite from binary file
+  // Load 64x64 1-bit sprite from pokemon_sprites.bin straight into the slot
   extern bool loadPokemonSprite(uint16_t pokemonId, uint8_t* spriteBuffer, size_t bufferSize);
-  if (!loadPokemonSprite(id, spriteBuffer1bpp, sizeof(spriteBuffer1bpp))) {
-    std::cout << "[CACHE] Failed to load 64x64 sprite for Pokemon " << id << std::endl;
+  CacheEntry& slot = evictLRU();
+  if (!loadPokemonSprite(id, slot.data64, sizeof(slot.data64))) {
+    std::cout << "[CACHE] Failed to load sprite for Pokemon " << id << std::endl;
     return nullptr;
   }
+  downscale64to32(slot.data64, slot.data32);
   
-  // Convert 1bpp to 4bpp format
-  memset(spriteBuffer4bpp, 0, sizeof(spriteBuffer4bpp));
-  int stride = (64 + 1) / 2; // Bytes per row in 4bpp format
-  
-  for (int y = 0; y < 64; y++) {
-    for (int x = 0; x < 64; x++) {
-      // Extract 1-bit pixel from source
-      int srcByteIndex = (y * 64 + x) / 8;
-      int srcBitIndex = (y * 64 + x) % 8;
-      bool pixel = (spriteBuffer1bpp[srcByteIndex] >> (7 - srcBitIndex)) & 1;
-      
-      // Convert to 4bpp format - invert pixel logic
-      if (!pixel) {
-        int dstByteIndex = y * stride + x / 2;
-        if (x % 2 == 0) {
-          spriteBuffer4bpp[dstByteIndex] |= 0x0F; // Low nibble - black pixel
-        } else {
-          spriteBuffer4bpp[dstByteIndex] |= 0xF0; // High nibble - black pixel
-        }
-      }
-    }
-  }
-  
-  return spriteBuffer4bpp;
+  slot.id = id;
+  slot.valid = true;
+  slot.lastUsed = ++accessCounter;
+  return &slot;
+}
+
+const uint8_t* SpriteCache::get32(uint16_t id) {
+  CacheEntry* entry = load(id);
+  if (!entry) return nullptr;
+  entry->lastUsed = ++accessCounter;
+  expand4bpp(entry->data32, 32, out32);
+  return out32;
+}
+
+const uint8_t* SpriteCache::get64(uint16_t id) {
+  CacheEntry* entry = load(id);
+  if (!entry) return nullptr;
+  entry->lastUsed = ++accessCounter;
+  expand4bpp(entry->data64, 64, out64);
+  return out64;
 }
 
 void SpriteCache::preload(uint16_t id) {
-  // Simple stub - do nothing for now
+  load(id);
+}
+
+void SpriteCache::queuePrefetch(uint16_t id) {
+  if (find(id)) return;
+  for (uint16_t queued : prefetchQueue) {
+    if (queued == id) return;
+  }
+  prefetchQueue.push_back(id);
+}
+
+// Loads the next queued sprite, returns false once the queue is empty
+bool SpriteCache::prefetchStep() {
+  while (!prefetchQueue.empty()) {
+    uint16_t id = prefetchQueue.front();
+    prefetchQueue.erase(prefetchQueue.begin());
+    if (find(id)) continue;
+    load(id);
+    return true;
+  }
+  return false;
 }
 
 // SearchModel implementation
@@ -0,0 +1,17 @@
+#include "RenderQueue.h"
+
+void RenderQueue::post(uint32_t bits) {
+  pending.fetch_or(bits, std::memory_order_release);
+#ifndef DESKTOP_EMULATOR
+  if (consumer) xTaskNotifyGive(consumer);
+#endif
+}
+
+void RenderQueue::wait(uint32_t timeoutMs) {
+#ifdef DESKTOP_EMULATOR
+  // The emulator main loop drives the handler itself
+  (void)timeoutMs;
+#else
+  ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeoutMs));
+#endif
+}
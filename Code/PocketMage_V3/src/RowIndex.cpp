@@ -0,0 +1,79 @@
+#include "RowIndex.h"
+
+void RowIndex::assign(const std::vector<uint32_t>& starts) {
+  gaps.resize(starts.size());
+  for (size_t r = 0; r < starts.size(); r++) gaps[r] = r ? starts[r] - starts[r - 1] : starts[r];
+  build();
+}
+
+void RowIndex::build() {
+  size_t n = gaps.size();
+  tree.assign(n + 1, 0);
+  for (size_t i = 1; i <= n; i++) {
+    tree[i] += gaps[i - 1];
+    size_t parent = i + (i & -i);
+    if (parent <= n) tree[parent] += tree[i];
+  }
+}
+
+void RowIndex::add(size_t row, long delta) {
+  gaps[row] += delta;
+  for (size_t i = row + 1; i < tree.size(); i += i & -i) tree[i] += delta;
+}
+
+uint32_t RowIndex::operator[](size_t row) const {
+  uint32_t sum = 0;
+  for (size_t i = row + 1; i > 0; i -= i & -i) sum += tree[i];
+  return sum;
+}
+
+size_t RowIndex::countAtOrBefore(uint32_t pos) const {
+  size_t n = gaps.size();
+  size_t step = 1;
+  while (step * 2 <= n) step *= 2;
+
+  // Gaps are never negative, so walk down the tree taking every block that fits
+  size_t count = 0;
+  for (; step > 0; step /= 2) {
+    if (count + step <= n && tree[count + step] <= pos) {
+      count += step;
+      pos -= tree[count];
+    }
+  }
+  return count;
+}
+
+size_t RowIndex::countBefore(uint32_t pos) const {
+  return pos == 0 ? 0 : countAtOrBefore(pos - 1);
+}
+
+void RowIndex::replace(size_t first, size_t last, const std::vector<uint32_t>& starts, long delta) {
+  if (starts.size() == last - first) {
+    // Same row count: patch the re-wrapped rows and the gap to the next one
+    uint32_t prev = first ? (*this)[first - 1] : 0;
+    uint32_t next = (last < gaps.size()) ? (*this)[last] + delta : 0;
+    for (size_t k = 0; k < starts.size(); k++) {
+      uint32_t gap = (first + k) ? starts[k] - prev : starts[k];
+      add(first + k, (long)gap - (long)gaps[first + k]);
+      prev = starts[k];
+    }
+    if (last < gaps.size()) add(last, (long)(next - prev) - (long)gaps[last]);
+    return;
+  }
+
+  std::vector<uint32_t> all(gaps.size() - (last - first) + starts.size());
+  uint32_t at = 0;
+  size_t out = 0;
+  for (size_t r = 0; r < gaps.size(); r++) {
+    at += gaps[r];
+    if (r == first) {
+      for (uint32_t s : starts) all[out++] = s;
+    }
+    if (r >= first && r < last) continue;
+    all[out++] = (r >= last) ? at + delta : at;
+  }
+  if (first >= gaps.size()) {
+    for (uint32_t s : starts) all[out++] = s;
+  }
+  assign(all);
+}
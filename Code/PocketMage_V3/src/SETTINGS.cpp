@@ -27,8 +27,8 @@ void settingCommandSelect(String command) {
       int month = datePart.substring(4, 6).toInt();
       int day   = datePart.substring(6, 8).toInt();
 
-      DateTime now = rtc.now();  // Preserve current time
-      rtc.adjust(DateTime(year, month, day, now.hour(), now.minute(), now.second()));
+      DateTime now = timeService.now();  // Preserve current time
+      timeService.set(DateTime(year, month, day, now.hour(), now.minute(), now.second()));
     } else {
       oledWord("Invalid format (use YYYYMMDD)");
       delay(2000);
@@ -284,8 +284,7 @@ void processKB_settings() {
 }
 
 void einkHandler_settings() {
-  if (newState) {
-    newState = false;
+  if (newState.take()) {
 
     // Load settings
     loadState(false);
@@ -0,0 +1,127 @@
+#include "globals.h"
+
+static char* cacheAlloc(size_t size) {
+  return (char*)(psramFound() ? ps_malloc(size) : malloc(size));
+}
+
+// WRITE-BACK APPENDS
+SdCache::Slot* SdCache::find(const String& path) {
+  for (Slot& s : slots) {
+    if (s.used > 0 && s.path == path) return &s;
+  }
+  return nullptr;
+}
+
+// An empty slot, or the one appended to least recently after writing it out
+SdCache::Slot* SdCache::claim(const String& path) {
+  Slot* pick = nullptr;
+  for (Slot& s : slots) {
+    if (s.used == 0 && (!pick || (s.buf && !pick->buf))) pick = &s;
+  }
+  if (!pick) {
+    pick = &slots[0];
+    for (Slot& s : slots) {
+      if (s.lastAppend < pick->lastAppend) pick = &s;
+    }
+    writeOut(*pick);
+  }
+  pick->path = path;
+  return pick;
+}
+
+void SdCache::writeOut(Slot& s) {
+  if (s.used == 0) return;
+  IoBoostSession ioBoost;
+
+  File file = SD_MMC.open(s.path, FILE_APPEND);
+  if (!file) {
+    Serial.println("SD cache failed to open " + s.path);
+    s.used = 0;
+    return;
+  }
+  if (file.write((const uint8_t*)s.buf, s.used) != s.used) {
+    Serial.println("SD cache write failed: " + s.path);
+  }
+  file.close();
+  s.used = 0;
+
+  sdIndex.update(s.path);
+}
+
+bool SdCache::append(const String& path, const char* data, size_t len) {
+  if (len > SD_CACHE_SIZE) {
+    flush(path);
+    return false;
+  }
+
+  Slot* s = find(path);
+  if (!s) s = claim(path);
+  if (!s->buf) s->buf = cacheAlloc(SD_CACHE_SIZE);
+  if (!s->buf) return false;
+
+  if (s->used + len > SD_CACHE_SIZE) writeOut(*s);
+  memcpy(s->buf + s->used, data, len);
+  s->used += len;
+  s->lastAppend = millis();
+  return true;
+}
+
+void SdCache::flush(const String& path) {
+  Slot* s = find(path);
+  if (s) writeOut(*s);
+}
+
+void SdCache::discard(const String& path) {
+  Slot* s = find(path);
+  if (s) s->used = 0;
+}
+
+void SdCache::flushAll() {
+  for (Slot& s : slots) writeOut(s);
+}
+
+void SdCache::idle() {
+  for (Slot& s : slots) {
+    if (s.used > 0 && millis() - s.lastAppend >= SD_CACHE_IDLE_MS) writeOut(s);
+  }
+}
+
+// READ-AHEAD
+SdLineReader::SdLineReader(File& file) : file(file), buf(cacheAlloc(SD_READ_AHEAD)) {}
+
+SdLineReader::~SdLineReader() {
+  free(buf);
+}
+
+bool SdLineReader::fill() {
+  if (eof) return false;
+  pos = 0;
+  len = file.read((uint8_t*)buf, SD_READ_AHEAD);
+  if (len == 0) eof = true;
+  return !eof;
+}
+
+bool SdLineReader::readLine(String& line) {
+  line = "";
+  // No buffer to spare, fall back to the stream reader
+  if (!buf) {
+    if (!file.available()) return false;
+    line = file.readStringUntil('\n');
+    return true;
+  }
+
+  bool any = false;
+  while (pos < len || fill()) {
+    any = true;
+    const char* start = buf + pos;
+    const char* nl = (const char*)memchr(start, '\n', len - pos);
+    size_t n = nl ? (size_t)(nl - start) : len - pos;
+    line.concat(start, n);
+    pos += n;
+    if (nl) {
+      pos++;
+      return true;
+    }
+  }
+  return any;
+}
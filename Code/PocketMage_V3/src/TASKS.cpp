@@ -17,100 +17,236 @@ void TASKS_INIT() {
   newState = true;
 }
 
-void sortTasksByDueDate(std::vector<std::vector<String>> &tasks) {
-  std::sort(tasks.begin(), tasks.end(), [](const std::vector<String> &a, const std::vector<String> &b) {
-    return a[1] < b[1]; // Compare dueDate strings
-  });
+// TASK STORE
+// SYS_TASKS_FILE is a TASKS_HEADER line followed by one record per task:
+//   state|priority|YYYYMMDD|name
+// with state '0' open, '1' done or 'x' deleted. Adding a task appends its
+// record; checking one off or deleting it rewrites the state byte in place,
+// and the file is rewritten with only the live records once deleted ones pile
+// up. Files in the old name|due|priority|completed form are converted on load.
+#define TASKS_HEADER "#tasks 2"
+
+static bool     tasksLoaded = false;
+static uint32_t tasksEnd = 0;     // file size, where the next record goes
+static uint32_t deadTasks = 0;
+
+static char taskState(const Task& t) {
+  return t.completed ? '1' : '0';
 }
 
-void addTask(String taskName, String dueDate, String priority, String completed) {
-  String taskInfo = taskName+"|"+dueDate+"|"+priority+"|"+completed;
-  updateTaskArray();
-  tasks.push_back({taskName, dueDate, priority, completed});
-  sortTasksByDueDate(tasks);
-  updateTasksFile();
+static String taskRecord(const Task& t) {
+  char head[20];
+  snprintf(head, sizeof(head), "%c|%u|%08lu|", taskState(t), t.priority, (unsigned long)t.due);
+  return String(head) + t.name + "\n";
+}
+
+static bool parseTaskRecord(const String& line, Task& t, char& state) {
+  int dueSep = line.indexOf('|', 2);
+  if (line.length() < 2 || line[1] != '|' || dueSep == -1) return false;
+  if ((int)line.length() < dueSep + 10 || line[dueSep + 9] != '|') return false;
+
+  state       = line[0];
+  t.priority  = line.substring(2, dueSep).toInt();
+  t.due       = parseTaskDate(line.substring(dueSep + 1, dueSep + 9));
+  t.name      = line.substring(dueSep + 10);
+  t.completed = state == '1';
+  return t.due != 0;
+}
+
+static bool parseLegacyTask(const String& line, Task& t) {
+  int delimiterPos1 = line.indexOf('|');
+  int delimiterPos2 = line.indexOf('|', delimiterPos1 + 1);
+  int delimiterPos3 = line.indexOf('|', delimiterPos2 + 1);
+  if (delimiterPos1 == -1 || delimiterPos2 == -1 || delimiterPos3 == -1) return false;
+
+  t.name      = line.substring(0, delimiterPos1);
+  t.due       = parseTaskDate(line.substring(delimiterPos1 + 1, delimiterPos2));
+  t.priority  = line.substring(delimiterPos2 + 1, delimiterPos3).toInt();
+  t.completed = line.substring(delimiterPos3 + 1) == "1";
+  return t.due != 0;
+}
+
+static void compactTasksFile() {
+  const char* tmpPath = "/sys/tasks.tmp";
+  File out = SD_MMC.open(tmpPath, FILE_WRITE);
+  if (!out) {
+    Serial.println("Failed to compact tasks.");
+    return;
+  }
+  // Queued records are already in tasks
+  sdCache.discard(SYS_TASKS_FILE);
+  String header = TASKS_HEADER "\n";
+  out.print(header);
+  uint32_t at = header.length();
+  for (Task& t : tasks) {
+    String record = taskRecord(t);
+    out.print(record);
+    t.offset = at;
+    at += record.length();
+  }
+  out.close();
+
+  SD_MMC.remove(SYS_TASKS_FILE);
+  SD_MMC.rename(tmpPath, SYS_TASKS_FILE);
+  tasksEnd = at;
+  deadTasks = 0;
+}
+
+static void appendTaskRecord(Task& t) {
+  String record = taskRecord(t);
+  t.offset = tasksEnd;
+  tasksEnd += record.length();
+  if (sdCache.append(SYS_TASKS_FILE, record.c_str(), record.length())) return;
+
+  File file = SD_MMC.open(SYS_TASKS_FILE, FILE_APPEND);
+  if (!file) {
+    Serial.println("Failed to open tasks file for writing.");
+    return;
+  }
+  file.print(record);
+  file.close();
+}
+
+// Overwrites the state byte at the start of t's record
+static bool writeTaskState(const Task& t, char state) {
+  sdCache.flush(SYS_TASKS_FILE);  // the record may still be queued
+  File file = SD_MMC.open(SYS_TASKS_FILE, "r+");
+  if (!file) {
+    Serial.println("Failed to open tasks file for update.");
+    return false;
+  }
+  file.seek(t.offset);
+  bool ok = file.write((const uint8_t*)&state, 1) == 1;
+  file.close();
+  return ok;
+}
+
+void sortTasksByDueDate(std::vector<Task> &tasks) {
+  std::stable_sort(tasks.begin(), tasks.end(), [](const Task &a, const Task &b) {
+    return a.due < b.due;
+  });
 }
 
+// Reads SYS_TASKS_FILE once; later calls use the loaded tasks
 void updateTaskArray() {
-  SDActive = true;
-  setCpuFrequencyMhz(240);
-  delay(50);
-  File file = SD_MMC.open("/sys/tasks.txt", "r"); // Open the text file in read mode
+  if (tasksLoaded) return;
+  IoBoostSession ioBoost;
+  sdCache.flush(SYS_TASKS_FILE);
+  File file = SD_MMC.open(SYS_TASKS_FILE, "r"); // Open the text file in read mode
   if (!file) {
-    Serial.println("Failed to open file for reading");
+    // Gone (e.g. deleted over USB): start an empty file with its header, so
+    // appends land at the offsets recorded for them
+    Serial.println("No tasks file, starting a new one");
+    tasks.clear();
+    deadTasks = 0;
+    tasksEnd = 0;
+    compactTasksFile();
+    tasksLoaded = SD_MMC.exists(SYS_TASKS_FILE);
     return;
   }
 
-  tasks.clear(); // Clear the existing vector before loading the new data
+  tasksLoaded = true;
+  tasks.clear();
+  deadTasks = 0;
+
+  bool hasHeader = false;
+  bool legacy = false;
+  uint32_t at = 0;
 
   // Loop through the file, line by line
-  while (file.available()) {
-    String line = file.readStringUntil('\n');  // Read a line from the file
-    line.trim();  // Remove any extra spaces or newlines
-    
-    // Skip empty lines
-    if (line.length() == 0) {
+  SdLineReader reader(file);
+  String line;
+  while (reader.readLine(line)) {
+    uint32_t start = at;
+    at += line.length() + 1;
+    line.trim();
+
+    if (start == 0 && line == TASKS_HEADER) {
+      hasHeader = true;
+      continue;
+    }
+    if (!hasHeader) legacy = true;
+    if (line.length() == 0) continue;
+
+    Task t;
+    char state = '0';
+    bool ok = legacy ? parseLegacyTask(line, t) : parseTaskRecord(line, t, state);
+    if (!ok || state == 'x') {
+      deadTasks++;
       continue;
     }
+    t.offset = start;
+    tasks.push_back(t);
+  }
 
-    // Split the line into individual parts using the delimiter '|'
-    uint8_t delimiterPos1 = line.indexOf('|');
-    uint8_t delimiterPos2 = line.indexOf('|', delimiterPos1 + 1);
-    uint8_t delimiterPos3 = line.indexOf('|', delimiterPos2 + 1);
+  // A last line without its newline would run into the next append
+  bool unterminated = at != file.size();
+  file.close();
+  tasksEnd = at;
 
-    // Extract task name, due date, priority, and completed status
-    String taskName  = line.substring(0, delimiterPos1);
-    String dueDate   = line.substring(delimiterPos1 + 1, delimiterPos2);
-    String priority  = line.substring(delimiterPos2 + 1, delimiterPos3);
-    String completed = line.substring(delimiterPos3 + 1);
+  sortTasksByDueDate(tasks);
+  if (!hasHeader || unterminated || deadTasks > tasks.size() + TASK_COMPACT_SLACK) compactTasksFile();
+}
 
-    // Add the task to the vector
-    tasks.push_back({taskName, dueDate, priority, completed});
-  }
+// The card changed under us (USB mode), reload on next use
+void invalidateTaskArray() {
+  tasksLoaded = false;
+}
 
-  file.close();  // Close the file
+void addTask(const String& taskName, uint32_t dueDate, uint8_t priority) {
+  IoBoostSession ioBoost;
+  updateTaskArray();
 
-  if (SAVE_POWER) setCpuFrequencyMhz(POWER_SAVE_FREQ);
-  SDActive = false;
+  Task t;
+  t.name      = taskName;
+  t.due       = dueDate;
+  t.priority  = priority;
+  t.completed = false;
+  appendTaskRecord(t);
+
+  // Keep tasks sorted, after any others due the same day
+  auto at = std::upper_bound(tasks.begin(), tasks.end(), dueDate,
+                             [](uint32_t due, const Task &task) { return due < task.due; });
+  tasks.insert(at, t);
 }
 
-void updateTasksFile() {
-  SDActive = true;
-  setCpuFrequencyMhz(240);
-  delay(50);
-  // Clear the existing tasks file first
-  delFile("/sys/tasks.txt");
-
-  // Iterate through the tasks vector and append each task to the file
-  for (size_t i = 0; i < tasks.size(); i++) {
-    // Create a string from the task's attributes with "|" delimiter
-    String taskInfo = tasks[i][0] + "|" + tasks[i][1] + "|" + tasks[i][2] + "|" + tasks[i][3];
-    
-    // Append the task info to the file
-    appendToFile("/sys/tasks.txt", taskInfo);
-  }
+void setTaskCompleted(int index, bool completed) {
+  if (index < 0 || index >= (int)tasks.size() || tasks[index].completed == completed) return;
+  IoBoostSession ioBoost;
 
-  if (SAVE_POWER) setCpuFrequencyMhz(POWER_SAVE_FREQ);
-  SDActive = false;
+  Task& t = tasks[index];
+  if (writeTaskState(t, completed ? '1' : '0')) t.completed = completed;
 }
 
 void deleteTask(int index) {
-  if (index >= 0 && index < tasks.size()) {
-    tasks.erase(tasks.begin() + index);
-  }
+  if (index < 0 || index >= (int)tasks.size()) return;
+  IoBoostSession ioBoost;
+
+  if (!writeTaskState(tasks[index], 'x')) return;
+  tasks.erase(tasks.begin() + index);
+  deadTasks++;
+  if (deadTasks > tasks.size() + TASK_COMPACT_SLACK) compactTasksFile();
 }
 
-String convertDateFormat(String yyyymmdd) {
-  if (yyyymmdd.length() != 8) {
-    Serial.println(("INVALID DATE: " + yyyymmdd).c_str());
-    return "Invalid";
+// YYYYMMDD as an integer, 0 if the text is not eight digits
+uint32_t parseTaskDate(const String& yyyymmdd) {
+  if (yyyymmdd.length() != 8) return 0;
+  uint32_t date = 0;
+  for (int i = 0; i < 8; i++) {
+    char c = yyyymmdd[i];
+    if (c < '0' || c > '9') return 0;
+    date = date * 10 + (c - '0');
   }
+  return date;
+}
 
-  String year = yyyymmdd.substring(2, 4);  // Get last two digits of the year
-  String month = yyyymmdd.substring(4, 6);
-  String day = yyyymmdd.substring(6, 8);
+String convertDateFormat(uint32_t yyyymmdd) {
+  if (yyyymmdd == 0) return "Invalid";
 
-  return month + "/" + day + "/" + year;
+  char out[12];
+  snprintf(out, sizeof(out), "%02u/%02u/%02u",
+           (unsigned)(yyyymmdd / 100 % 100), (unsigned)(yyyymmdd % 100), (unsigned)(yyyymmdd / 10000 % 100));
+  return String(out);
 }
 
 void processKB_TASKS() {
@@ -213,13 +349,13 @@ void processKB_TASKS() {
               newState = true;
               break;
             case 1: // ENTER DUE DATE
-              String testDate = convertDateFormat(currentLine);
+              uint32_t dueDate = parseTaskDate(currentLine);
               // DATE IS VALID
-              if (testDate != "Invalid") {
+              if (dueDate != 0) {
                 newTaskDueDate = currentLine;
 
                 // ADD NEW TASK
-                addTask(newTaskName, newTaskDueDate, "0", "0");
+                addTask(newTaskName, dueDate);
                 oledWord("New Task Added");
                 delay(1000);
 
@@ -273,7 +409,7 @@ void processKB_TASKS() {
           break;
         }
         // SELECT A TASK
-        else if (inchar >= '1' && inchar <= '4') {
+        else if (inchar >= '1' && inchar <= '5') {
           if (inchar == '1') {      // RENAME TASK
 
           }
@@ -282,7 +418,6 @@ void processKB_TASKS() {
           }
           else if (inchar == '3') { // DELETE TASK
             deleteTask(selectedTask);
-            updateTasksFile();
             
             CurrentTasksState = TASKS0;
             forceSlowFullUpdate = true;
@@ -291,6 +426,13 @@ void processKB_TASKS() {
           else if (inchar == '4') { // COPY TASK
 
           }
+          else if (inchar == '5') { // CHECK OFF / REOPEN TASK
+            setTaskCompleted(selectedTask, !tasks[selectedTask].completed);
+
+            CurrentTasksState = TASKS0;
+            forceSlowFullUpdate = true;
+            newState = true;
+          }
           
         }
 
@@ -310,8 +452,7 @@ void processKB_TASKS() {
 void einkHandler_TASKS() {
   switch (CurrentTasksState) {
     case TASKS0:
-      if (newState) {
-        newState = false;
+      if (newState.take()) {
         display.setRotation(3);
         display.setFullWindow();
         display.fillScreen(GxEPD_WHITE);
@@ -321,7 +462,6 @@ void einkHandler_TASKS() {
 
         // DRAW FILE LIST
         updateTaskArray();
-        sortTasksByDueDate(tasks);
 
         if (!tasks.empty()) {
           if (DEBUG_VERBOSE) Serial.println("Printing Tasks");
@@ -333,11 +473,18 @@ void einkHandler_TASKS() {
             display.setFont(&FreeSerif9pt7b);
             // PRINT TASK NAME
             display.setCursor(29, 54 + (17 * i));
-            display.print(tasks[i][0].c_str());
+            display.print(tasks[i].name.c_str());
+            // STRIKE OUT DONE TASKS
+            if (tasks[i].completed) {
+              int16_t x1, y1;
+              uint16_t w, h;
+              display.getTextBounds(tasks[i].name.c_str(), 29, 54 + (17 * i), &x1, &y1, &w, &h);
+              display.drawLine(29, 50 + (17 * i), 29 + w, 50 + (17 * i), GxEPD_BLACK);
+            }
             // PRINT TASK DUE DATE
             display.setCursor(231, 54 + (17 * i));
-            display.print(convertDateFormat(tasks[i][1]).c_str());
-            Serial.print(tasks[i][0].c_str()); Serial.println(convertDateFormat(tasks[i][1]).c_str());
+            display.print(convertDateFormat(tasks[i].due).c_str());
+            Serial.print(tasks[i].name.c_str()); Serial.println(convertDateFormat(tasks[i].due).c_str());
           }
         }
         else drawStatusBar("No Tasks! Add New Task (N)");
@@ -346,8 +493,7 @@ void einkHandler_TASKS() {
       }
       break;
       case TASKS0_NEWTASK:
-        if (newState) {
-          newState = false;
+        if (newState.take()) {
           display.setRotation(3);
           display.setFullWindow();
           display.fillScreen(GxEPD_WHITE);
@@ -357,7 +503,6 @@ void einkHandler_TASKS() {
 
           // DRAW FILE LIST
           updateTaskArray();
-          sortTasksByDueDate(tasks);
 
           if (!tasks.empty()) {
             if (DEBUG_VERBOSE) Serial.println("Printing Tasks");
@@ -367,11 +512,18 @@ void einkHandler_TASKS() {
               display.setFont(&FreeSerif9pt7b);
               // PRINT TASK NAME
               display.setCursor(29, 54 + (17 * i));
-              display.print(tasks[i][0].c_str());
+              display.print(tasks[i].name.c_str());
+              // STRIKE OUT DONE TASKS
+              if (tasks[i].completed) {
+                int16_t x1, y1;
+                uint16_t w, h;
+                display.getTextBounds(tasks[i].name.c_str(), 29, 54 + (17 * i), &x1, &y1, &w, &h);
+                display.drawLine(29, 50 + (17 * i), 29 + w, 50 + (17 * i), GxEPD_BLACK);
+              }
               // PRINT TASK DUE DATE
               display.setCursor(231, 54 + (17 * i));
-              display.print(convertDateFormat(tasks[i][1]).c_str());
-              Serial.print(tasks[i][0].c_str()); Serial.println(convertDateFormat(tasks[i][1]).c_str());
+              display.print(convertDateFormat(tasks[i].due).c_str());
+              Serial.print(tasks[i].name.c_str()); Serial.println(convertDateFormat(tasks[i].due).c_str());
             }
           }
           switch (newTaskState) {
@@ -387,14 +539,13 @@ void einkHandler_TASKS() {
         }
         break;
     case TASKS1:
-      if (newState) {
-        newState = false;
+      if (newState.take()) {
         display.setRotation(3);
         display.setFullWindow();
         display.fillScreen(GxEPD_WHITE);
 
         // DRAW APP
-        drawStatusBar("T:" + tasks[selectedTask][0]);
+        drawStatusBar("T:" + tasks[selectedTask].name + (tasks[selectedTask].completed ? " (Done)" : "") + " | 5:Check");
         display.drawBitmap(0, 0, tasksApp1, 320, 218, GxEPD_BLACK);
 
         refresh();
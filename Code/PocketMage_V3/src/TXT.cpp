@@ -6,13 +6,20 @@
 //       888        d8'  `888b        888       //
 //      o888o     o888o  o88888o     o888o      //
 #include "globals.h"
+#include "GlyphAdvance.h"
 #ifdef DESKTOP_EMULATOR
 #include "U8g2lib.h"
 #endif
 
+static long paintedCursorRow = 0;  // row the e-ink caret was last drawn on
+
+static void txtViewKB(const KeyEvent& keyEvent, bool hasInput);
+
 void TXT_INIT() {
   std::cout << "[POCKETMAGE] TXT_INIT() starting..." << std::endl;
   if (editingFile != "") loadFile();
+  if (lineStarts.empty() || lineStarts.size() != allLines.size()) txtLayout();
+  cursorLine = txtLineForPos(txtCursor);
   CurrentAppState = TXT;
   CurrentTXTState = TXT_;
   CurrentKBState  = NORMAL;
@@ -23,6 +30,167 @@ void TXT_INIT() {
   std::cout << "[POCKETMAGE] TXT_INIT() complete - CurrentAppState=TXT, CurrentTXTState=TXT_, newState=true, doFull=true" << std::endl;
 }
 
+// DOCUMENT LAYOUT
+// allLines holds the wrapped rows of txtDoc and lineStarts the document offset
+// of each row. Rows cover the document exactly: a soft-wrapped row keeps its
+// trailing space and the '\n' ending a paragraph belongs to no row.
+// Wrap one paragraph (no '\n') starting at document offset base. Widths come
+// from the font's advance table and are summed as we go.
+void txtWrapParagraph(const String& para, size_t base, std::vector<String>& rows, std::vector<uint32_t>& starts) {
+  const GlyphAdvance& adv = glyphAdvance(currentFont);
+  const uint16_t maxWidth = display.width() - 5;
+  size_t rowStart = 0;
+  long lastSpace = -1;
+  uint16_t width = 0;
+  size_t i = 0;
+
+  while (i < para.length()) {
+    // Step over a whole UTF-8 character
+    size_t next = i + 1;
+    while (next < para.length() && (para[next] & 0xC0) == 0x80) next++;
+
+    uint8_t w = adv.charWidth(para[i]);
+    if (i > rowStart && width + w >= maxWidth) {
+      size_t breakAt;
+      if (para[i] == ' ')      breakAt = next;           // Space stays on this row
+      else if (lastSpace >= 0) breakAt = lastSpace + 1;  // Carry the partial word down
+      else                     breakAt = i;              // Single long word, hard break
+
+      rows.push_back(para.substring(rowStart, breakAt));
+      starts.push_back(base + rowStart);
+      rowStart = breakAt;
+      lastSpace = -1;
+      width = adv.measure(para, rowStart, next);
+    }
+    else width += w;
+
+    if (para[i] == ' ' && i >= rowStart) lastSpace = i;
+    i = next;
+  }
+
+  rows.push_back(para.substring(rowStart));
+  starts.push_back(base + rowStart);
+}
+
+// Wrap a run of whole paragraphs starting at document offset base
+static void wrapRange(const String& text, size_t base, std::vector<String>& rows, std::vector<uint32_t>& starts) {
+  size_t start = 0;
+  while (true) {
+    int nl = text.indexOf('\n', start);
+    size_t end = (nl < 0) ? text.length() : nl;
+    txtWrapParagraph(text.substring(start, end), base + start, rows, starts);
+    if (nl < 0) break;
+    start = end + 1;
+  }
+}
+
+void txtLayout() {
+  setTXTFont(currentFont);
+  allLines.clear();
+  std::vector<uint32_t> starts;
+  wrapRange(txtDoc.toString(), 0, allLines, starts);
+  lineStarts.assign(starts);
+}
+
+// Re-wrap only the paragraph(s) touched by an edit at pos. delta is the number
+// of bytes inserted (negative when erased). Returns true if rows other than the
+// edited one moved, i.e. the visible text reflowed.
+bool txtLayoutAt(size_t pos, long delta) {
+  if (lineStarts.empty() || lineStarts.size() != allLines.size()) {
+    txtLayout();
+    return true;
+  }
+  setTXTFont(currentFont);
+
+  size_t paraStart = txtDoc.lineStart(pos);
+  size_t newEnd    = txtDoc.lineEnd(delta > 0 ? pos + delta : pos);
+  size_t oldEnd    = newEnd - delta;
+
+  size_t firstRow = lineStarts.countBefore(paraStart);
+  size_t lastRow  = lineStarts.countAtOrBefore(oldEnd);
+
+  std::vector<String> rows;
+  std::vector<uint32_t> starts;
+  wrapRange(txtDoc.substring(paraStart, newEnd), paraStart, rows, starts);
+
+  // Did anything besides the edited row change?
+  bool reflowed = rows.size() != lastRow - firstRow;
+  for (size_t k = 0; !reflowed && k < rows.size(); k++) {
+    uint32_t old = lineStarts[firstRow + k];
+    reflowed = starts[k] != ((old > pos) ? old + delta : old);
+  }
+
+  if (rows.size() == lastRow - firstRow) {
+    for (size_t k = 0; k < rows.size(); k++) allLines[firstRow + k] = rows[k];
+  }
+  else {
+    allLines.erase(allLines.begin() + firstRow, allLines.begin() + lastRow);
+    allLines.insert(allLines.begin() + firstRow, rows.begin(), rows.end());
+  }
+  lineStarts.replace(firstRow, lastRow, starts, delta);
+
+  return reflowed;
+}
+
+long txtLineForPos(size_t pos) {
+  long row = (long)lineStarts.countAtOrBefore(pos) - 1;
+  return (row < 0) ? 0 : row;
+}
+
+// CURSOR
+// Scroll the view so the cursor row is on screen, returns true if it scrolled
+static bool txtScrollToCursor() {
+  long size  = allLines.size();
+  long shown = (maxLines < size) ? maxLines : size;
+  long first = size - shown - dynamicScroll;
+
+  if (cursorLine < first)               dynamicScroll = size - shown - cursorLine;
+  else if (cursorLine >= first + shown) dynamicScroll = size - cursorLine - 1;
+  else return false;
+
+  if (dynamicScroll < 0) dynamicScroll = 0;
+  return true;
+}
+
+static void txtSyncCursorRow() {
+  cursorLine  = txtLineForPos(txtCursor);
+  currentLine = allLines[cursorLine];
+}
+
+// After an edit only redraw the e-ink when rows reflowed or the cursor changed
+// rows; typing inside a row is echoed on the OLED.
+static void txtEdited(size_t pos, long delta) {
+  long prevRow  = cursorLine;
+  bool reflowed = txtLayoutAt(pos, delta);
+  txtSyncCursorRow();
+
+  if (reflowed || txtScrollToCursor()) newLineAdded = true;
+  else if (cursorLine != prevRow)      cursorMoved = true;
+}
+
+static void txtInsert(const String& text) {
+  size_t pos = txtCursor;
+  txtDoc.insert(pos, text);
+  txtCursor += text.length();
+  txtEdited(pos, text.length());
+}
+
+static void txtErase(size_t from, size_t to) {
+  if (to <= from) return;
+  txtDoc.erase(from, to - from);
+  txtCursor = from;
+  txtEdited(from, -(long)(to - from));
+}
+
+static void txtMoveCursor(size_t pos) {
+  if (pos == txtCursor) return;
+  txtCursor = pos;
+  txtSyncCursorRow();
+
+  if (txtScrollToCursor()) newLineAdded = true;
+  else                     cursorMoved = true;
+}
+
 // OLD MAINS
 void processKB_TXT() {
   /*if (OLEDPowerSave) {
@@ -396,8 +564,8 @@ void processKB_TXT() {
 }
 
 void einkHandler_TXT() {
-  if ((prevAllText != allText) || newState) {
-    newState = false;
+  bool stateReq = newState.take();
+  if ((prevAllText != allText) || stateReq) {
     switch (CurrentTXTState) {
       case TXT_:
         prevAllText = allText;
@@ -424,7 +592,7 @@ void einkHandler_TXT() {
         display.drawBitmap(60,0,fileWizLiteallArray[0],200,218, GxEPD_BLACK);
 
         keypad.disableInterrupts();
-        listDir(SD_MMC, "/");
+        listDir();
         keypad.enableInterrupts();
 
         for (int i = 0; i < MAX_FILES; i++) {
@@ -513,121 +681,138 @@ void processKB_TXT_NEW() {
         // SET MAXIMUMS AND FONT
         setTXTFont(currentFont);
 
+        // LARGE FILE OPEN IN THE READ-ONLY VIEWER
+        if (txtView.isOpen()) {
+          txtViewKB(keyEvent, hasInput);
+          break;
+        }
+
+        // KEEP THE LAYOUT AND CURSOR ROW IN SYNC WITH THE DOCUMENT
+        if (lineStarts.empty() || lineStarts.size() != allLines.size()) txtLayout();
+        txtSyncCursorRow();
+
         // UPDATE SCROLLBAR
         updateScrollFromTouch();
 
         // HANDLE INPUTS
-        //No input received
-        if (!hasInput);  
-        else if (keyEvent.action == KA_ESC || keyEvent.action == KA_HOME) {
-          CurrentAppState = HOME;
-          currentLine     = "";
-          newState        = true;
-          CurrentKBState  = NORMAL;
-        }
-        //TAB Received
-        else if (keyEvent.action == KA_TAB) {                                  
-          currentLine += "    ";
-        }
-        //SHIFT and FN are handled automatically by updateKeypressUTF8()
-        //Space Received
-        else if (keyEvent.action == KA_SPACE) {                                  
-          currentLine += " ";
-        }
-        //CR Received
-        else if (keyEvent.action == KA_ENTER) {                          
-          allLines.push_back(currentLine);
-          currentLine = "";
-          newLineAdded = true;
-        }
-        //ESC / CLEAR Received
-        else if (keyEvent.action == KA_CLEAR) {                                  
-          allLines.clear();
-          currentLine = "";
-          oledWord("Clearing...");
-          doFull = true;
-          newLineAdded = true;
-          delay(300);
-        }
-        // LEFT
-        else if (keyEvent.action == KA_LEFT) {                                  
-          
-        }
-        // RIGHT
-        else if (keyEvent.action == KA_RIGHT) {                                  
-          
-        }
-        //BKSP Received
-        else if (keyEvent.action == KA_BACKSPACE) {                  
-          if (currentLine.length() > 0) {
-            // UTF-8 safe backspace
-            currentLine = utf8SafeBackspace(currentLine);
+        // Keys typed while the last pass was busy are applied together, so a
+        // burst reflows and redraws once
+        for (int batch = 1; hasInput; batch++) {
+          if (keyEvent.action == KA_ESC || keyEvent.action == KA_HOME) {
+            CurrentAppState = HOME;
+            currentLine     = "";
+            newState        = true;
+            CurrentKBState  = NORMAL;
           }
-        }
-        //SAVE Received
-        else if (keyEvent.action == KA_SAVE) {
-          //File exists, save normally
-          if (editingFile != "" && editingFile != "-") {
-            saveFile();
+          //TAB Received
+          else if (keyEvent.action == KA_TAB) {                                  
+            txtInsert("    ");
+          }
+          //SHIFT and FN are handled automatically by updateKeypressUTF8()
+          //Space Received
+          else if (keyEvent.action == KA_SPACE) {                                  
+            txtInsert(" ");
+          }
+          //CR Received
+          else if (keyEvent.action == KA_ENTER) {                          
+            txtInsert("\n");
+          }
+          //ESC / CLEAR Received
+          else if (keyEvent.action == KA_CLEAR) {                                  
+            txtDoc.clear();
+            txtCursor = 0;
+            txtLayout();
+            txtSyncCursorRow();
+            oledWord("Clearing...");
+            doFull = true;
+            newLineAdded = true;
+            delay(300);
+          }
+          // LEFT
+          else if (keyEvent.action == KA_LEFT) {                                  
+            txtMoveCursor(txtDoc.prevChar(txtCursor));
+          }
+          // RIGHT
+          else if (keyEvent.action == KA_RIGHT) {                                  
+            txtMoveCursor(txtDoc.nextChar(txtCursor));
+          }
+          //BKSP Received (UTF-8 safe)
+          else if (keyEvent.action == KA_BACKSPACE) {                  
+            txtErase(txtDoc.prevChar(txtCursor), txtCursor);
+          }
+          //DEL Received
+          else if (keyEvent.action == KA_DELETE) {
+            txtErase(txtCursor, txtDoc.nextChar(txtCursor));
+          }
+          //SAVE Received
+          else if (keyEvent.action == KA_SAVE) {
+            //File exists, save normally
+            if (editingFile != "" && editingFile != "-") {
+              saveFile();
+              CurrentKBState = NORMAL;
+              newLineAdded = true;
+            }
+            //File does not exist, make a new one
+            else {
+              CurrentTXTState = WIZ3;
+              currentLine = "";
+              CurrentKBState = NORMAL;
+              doFull = true;
+              newState = true;
+            }
+          }
+          //LOAD Received
+          else if (keyEvent.action == KA_LOAD) {
+            loadFile();
             CurrentKBState = NORMAL;
             newLineAdded = true;
           }
-          //File does not exist, make a new one
-          else {
-            CurrentTXTState = WIZ3;
-            currentLine = "";
+          //FILE Received
+          else if (keyEvent.action == KA_FILE) {
+            CurrentTXTState = WIZ0;
             CurrentKBState = NORMAL;
-            doFull = true;
             newState = true;
           }
-        }
-        //LOAD Received
-        else if (keyEvent.action == KA_LOAD) {
-          loadFile();
-          CurrentKBState = NORMAL;
-          newLineAdded = true;
-        }
-        //FILE Received
-        else if (keyEvent.action == KA_FILE) {
-          CurrentTXTState = WIZ0;
-          CurrentKBState = NORMAL;
-          newState = true;
-        }
-        // Font Switcher 
-        else if (keyEvent.action == KA_FONT) {                                  
-          CurrentTXTState = FONT;
-          CurrentKBState = FUNC;
-          newState = true;
-        }
-        // Cycle keyboard layout (Fn+K)
-        else if (keyEvent.action == KA_CYCLE_LAYOUT) {
-          cycleKeyboardLayout();
-        }
-        // Handle dead key input
-        else if (keyEvent.action == KA_DEAD && keyEvent.text.length() > 0) {
-          CurrentDead = keyEvent.text;
-          std::cout << "[TXT] Dead key activated: '" << keyEvent.text.c_str() << "'" << std::endl;
-        }
-        // Handle UTF-8 character input
-        else if (keyEvent.action == KA_CHAR && keyEvent.text.length() > 0) {
-          String composedText = composeDeadIfAny(keyEvent.text);
-          currentLine += composedText;
-          // Reset modifier states after character input (except for numbers in FN mode)
-          if (CurrentKBState == FUNC) {
-            // Check if the input contains digits to keep FN mode active
-            bool hasDigit = false;
-            for (int i = 0; i < keyEvent.text.length(); i++) {
-              if (keyEvent.text[i] >= '0' && keyEvent.text[i] <= '9') {
-                hasDigit = true;
-                break;
+          // Font Switcher 
+          else if (keyEvent.action == KA_FONT) {                                  
+            CurrentTXTState = FONT;
+            CurrentKBState = FUNC;
+            newState = true;
+          }
+          // Cycle keyboard layout (Fn+K)
+          else if (keyEvent.action == KA_CYCLE_LAYOUT) {
+            cycleKeyboardLayout();
+          }
+          // Handle dead key input
+          else if (keyEvent.action == KA_DEAD && keyEvent.text.length() > 0) {
+            CurrentDead = keyEvent.text;
+            std::cout << "[TXT] Dead key activated: '" << keyEvent.text.c_str() << "'" << std::endl;
+          }
+          // Handle UTF-8 character input
+          else if (keyEvent.action == KA_CHAR && keyEvent.text.length() > 0) {
+            String composedText = composeDeadIfAny(keyEvent.text);
+            txtInsert(composedText);
+            // Reset modifier states after character input (except for numbers in FN mode)
+            if (CurrentKBState == FUNC) {
+              // Check if the input contains digits to keep FN mode active
+              bool hasDigit = false;
+              for (int i = 0; i < keyEvent.text.length(); i++) {
+                if (keyEvent.text[i] >= '0' && keyEvent.text[i] <= '9') {
+                  hasDigit = true;
+                  break;
+                }
               }
-            }
-            if (!hasDigit && CurrentKBState != NORMAL) {
+              if (!hasDigit && CurrentKBState != NORMAL) {
+                CurrentKBState = NORMAL;
+              }
+            } else if (CurrentKBState != NORMAL) {
               CurrentKBState = NORMAL;
             }
-          } else if (CurrentKBState != NORMAL) {
-            CurrentKBState = NORMAL;
           }
+
+          if (CurrentAppState != TXT || CurrentTXTState != TXT_ || batch >= KB_BATCH_MAX) break;
+          keyEvent = updateKeypressUTF8();
+          hasInput = keyEvent.hasEvent;
         }
 
         currentMillis = millis();
@@ -636,44 +821,12 @@ void processKB_TXT_NEW() {
           OLEDFPSMillis = currentMillis;
           // ONLY SHOW OLEDLINE WHEN NOT IN SCROLL MODE
           if (lastTouch == -1) {
-            oledLine(currentLine);
+            oledLine(currentLine, true, "", txtCursor - lineStarts[cursorLine]);
             if (prev_dynamicScroll != dynamicScroll) prev_dynamicScroll = dynamicScroll;
           }
           else oledScroll();
         }
 
-        if (currentLine.length() > 0) {
-          int16_t x1, y1;
-          uint16_t charWidth, charHeight;
-          display.getTextBounds(currentLine, 0, 0, &x1, &y1, &charWidth, &charHeight);
-
-          if (charWidth >= display.width()-5) {
-            // If currentLine ends with a space, just start a new line
-            if (currentLine.endsWith(" ")) {
-              allLines.push_back(currentLine);
-              currentLine = "";
-            }
-            // If currentLine ends with a letter, we are in the middle of a word
-            else {
-              int lastSpace = currentLine.lastIndexOf(' ');
-              String partialWord;
-
-              if (lastSpace != -1) {
-                partialWord = currentLine.substring(lastSpace + 1);
-                currentLine = currentLine.substring(0, lastSpace);  // Strip partial word
-                allLines.push_back(currentLine);
-                currentLine = partialWord;  // Start new line with the partial word
-              } 
-              // No spaces found, whole line is a single word
-              else {
-                allLines.push_back(currentLine);
-                currentLine = "";
-              }
-            }
-            newLineAdded = true;
-          }
-        }
-
         break;
       case WIZ0:
         //No input received
@@ -687,6 +840,16 @@ void processKB_TXT_NEW() {
           currentLine = "";
           display.fillScreen(GxEPD_WHITE);
         }
+        // PAGE AND SORT THE FILE LIST
+        else if (keyEvent.action == KA_LEFT || keyEvent.action == KA_RIGHT) {
+          uint16_t prevPage = filesPage;
+          filesPageStep(keyEvent.action == KA_LEFT ? -1 : 1);
+          if (filesPage != prevPage) newState = true;
+        }
+        else if (keyEvent.action == KA_SELECT) {
+          filesCycleSort();
+          newState = true;
+        }
         else if (keyEvent.action == KA_CHAR && keyEvent.text.length() == 1 && keyEvent.text[0] >= '0' && keyEvent.text[0] <= '9'){
           int fileIndex = (keyEvent.text[0] == '0') ? 10 : (keyEvent.text[0] - '0');
           //Edit a new file
@@ -938,9 +1101,8 @@ void processKB_TXT_NEW() {
           // SET THE FONT
           setTXTFont(currentFont);
 
-          // UPDATE THE ARRAY TO MATCH NEW FONT SIZE
-          String fullTextStr = vectorToString();
-          stringToVector(fullTextStr);
+          // REWRAP THE DOCUMENT FOR THE NEW FONT SIZE
+          txtLayout();
 
           CurrentTXTState = TXT_;
           CurrentKBState = NORMAL;
@@ -964,23 +1126,40 @@ void processKB_TXT_NEW() {
 }
 
 void einkHandler_TXT_NEW() {
-  if (newLineAdded || newState) {
-    std::cout << "[POCKETMAGE] einkHandler_TXT_NEW() called - newLineAdded=" << newLineAdded << ", newState=" << newState << ", CurrentTXTState=" << CurrentTXTState << std::endl;
+  // Take the requests up front, anything posted while drawing stays queued for the next pass
+  uint32_t req = renderQueue.take(RENDER_STATE | RENDER_LINE | RENDER_CURSOR);
+  if (req) {
+    bool stateReq  = req & RENDER_STATE;
+    bool lineReq   = req & RENDER_LINE;
+    bool cursorReq = req & RENDER_CURSOR;
+    std::cout << "[POCKETMAGE] einkHandler_TXT_NEW() called - newLineAdded=" << lineReq << ", newState=" << stateReq << ", CurrentTXTState=" << CurrentTXTState << std::endl;
     switch (CurrentTXTState) {
       case TXT_:
-        std::cout << "[POCKETMAGE] TXT_ state - doFull=" << doFull << std::endl;
-        if (newState && doFull) {
+        std::cout << "[POCKETMAGE] TXT_ state - doFull=" << doFull.pending() << std::endl;
+        if (txtView.isOpen()) {
+          if (stateReq || lineReq) {
+            einkTextView();
+            refresh();
+          }
+          break;
+        }
+        if (stateReq && doFull.pending()) {
           std::cout << "[POCKETMAGE] Filling screen white and refreshing..." << std::endl;
           display.fillScreen(GxEPD_WHITE);
           std::cout << "[POCKETMAGE] Drawing text editor content..." << std::endl;
           einkTextDynamic(true, true);
           refresh();
-          newState = false;  // Reset state flag
         }
-        if (newLineAdded && !newState) {
+        if (lineReq && !stateReq) {
           einkTextDynamic(true);
           refresh();
         }
+        // CURSOR MOVED, REPAINT ONLY THE ROWS IT LEFT AND ENTERED
+        else if (cursorReq && !stateReq) {
+          if (paintedCursorRow != cursorLine) einkTextLine(paintedCursorRow);
+          einkTextLine(cursorLine);
+        }
+        paintedCursorRow = cursorLine;
         break;
       case WIZ0:
         display.setFullWindow();
@@ -997,7 +1176,7 @@ void einkHandler_TXT_NEW() {
         display.drawBitmap(60,0,fileWizLiteallArray[0],200,218, GxEPD_BLACK);
 
         keypad.disableInterrupts();
-        listDir(SD_MMC, "/");
+        listDir();
         keypad.enableInterrupts();
 
         for (int i = 0; i < MAX_FILES; i++) {
@@ -1065,7 +1244,7 @@ void einkHandler_TXT_NEW() {
         display.drawBitmap(60,0,fontfont0,200,218, GxEPD_BLACK);
 
         keypad.disableInterrupts();
-        listDir(SD_MMC, "/");
+        listDir();
         keypad.enableInterrupts();
 
         for (int i = 0; i < 7; i++) {
@@ -1101,8 +1280,6 @@ void einkHandler_TXT_NEW() {
         break;
     
     }
-    newState = false;
-    newLineAdded = false;
   }
 }
 
@@ -1215,44 +1392,185 @@ int countVisibleChars(String input) {
   return count;
 }
 
-void updateScrollFromTouch() {
-  uint16_t touched = cap.touched();  // Read touch state
-  int newTouch = -1;
-
-  // Find the first active touch point (lowest index first)
-  for (int i = 0; i < 9; i++) {
-    if (touched & (1 << i)) {
-      newTouch = i;
-      Serial.print("Prev pad: ");
-      Serial.print(lastTouch);
-      Serial.print("   Touched pad: ");
-      Serial.println(newTouch);
-      break;
-    }
+// TOUCH SLIDER
+// The MPR121 is only read when its IRQ reports a change (or, without
+// TOUCH_IRQ, every pass while in use and every TOUCH_IDLE_POLL_MS otherwise).
+// Finger movement feeds a velocity estimate; a quick flick keeps scrolling
+// after lift-off and slows down over TOUCH_COAST_MS. Movement is collected
+// and handed out as whole lines once per TOUCH_FRAME_MS, so a swipe becomes
+// a few larger scroll steps instead of one redraw per pad.
+static bool          fingerDown    = false;
+static float         touchVelocity = 0;   // pads per second, + toward higher pads
+static float         touchPending  = 0;   // lines not yet handed out
+static bool          touchCoasting = false;
+static unsigned long touchSampleMs = 0;
+static unsigned long touchMoveMs   = 0;
+static unsigned long touchFrameMs  = 0;
+static unsigned long touchPollMs   = 0;
+
+static bool touchReadDue(unsigned long now) {
+  if (TOUCH_IRQ >= 0) {
+    if (!MPR121_event) return false;
+    MPR121_event = false;  // reading the status releases the IRQ line
+    return true;
+  }
+  if (fingerDown || touchCoasting || now - touchPollMs >= TOUCH_IDLE_POLL_MS) {
+    touchPollMs = now;
+    return true;
   }
+  return false;
+}
+
+static void touchStop() {
+  touchCoasting = false;
+  touchVelocity = 0;
+  touchPending  = 0;
+}
 
+// Reads the touch slider: returns the lines to scroll, positive toward higher
+// pads. settled is set once the finger has been lifted and the scroll has
+// come to rest for long enough.
+static int touchSliderStep(bool& settled) {
+  settled = false;
   unsigned long currentTime = millis();
 
-  if (newTouch != -1) {  // If a touch is detected
-    Serial.println("Touch Detected");
-    if (lastTouch != -1) {  // Compare with previous touch
-      int touchDelta = abs(newTouch - lastTouch);
-      if (touchDelta <= 2) {  // Ignore large jumps (adjust threshold if needed)
-        int maxScroll = max(0, (int)allLines.size() - maxLines);  // Ensure a valid scroll range
-        if (newTouch > lastTouch) {
-          dynamicScroll = min((int)(dynamicScroll + 1), maxScroll);
-        } else if (newTouch < lastTouch) {
-          dynamicScroll = max((int)(dynamicScroll - 1), 0);
-        }
+  if (touchReadDue(currentTime)) {
+    uint16_t touched = cap.touched();  // Read touch state
+    int newTouch = -1;
+
+    // Find the first active touch point (lowest index first)
+    for (int i = 0; i < 9; i++) {
+      if (touched & (1 << i)) {
+        newTouch = i;
+        break;
       }
     }
-    lastTouch = newTouch;  // Always update lastTouch
-    lastTouchTime = currentTime;  // Reset timeout timer
-  } 
-  else if (lastTouch != -1 && (currentTime - lastTouchTime > TOUCH_TIMEOUT_MS)) {
+
+    if (newTouch != -1) {  // If a touch is detected
+      if (!fingerDown) {
+        touchStop();  // a new touch catches a coasting scroll
+        touchMoveMs = currentTime;
+      }
+      else if (lastTouch != -1 && newTouch != lastTouch && abs(newTouch - lastTouch) <= 2) {
+        // Ignore large jumps, otherwise follow the finger. Speed is measured
+        // from the previous move, so a finger that rested first reads as slow.
+        int moved = newTouch - lastTouch;
+        unsigned long dt = max(1UL, currentTime - touchMoveMs);
+        touchVelocity = 0.5f * touchVelocity + 0.5f * (moved * 1000.0f / dt);
+        touchPending += moved;
+        touchMoveMs = currentTime;
+      }
+      fingerDown = true;
+      lastTouch = newTouch;  // Always update lastTouch
+      touchSampleMs = currentTime;
+      lastTouchTime = currentTime;  // Reset timeout timer
+    }
+    else if (fingerDown) {
+      // LIFT-OFF: A FLICK KEEPS SCROLLING, A RESTING FINGER STOPS
+      fingerDown = false;
+      touchCoasting = (currentTime - touchMoveMs < TOUCH_FRAME_MS) && fabsf(touchVelocity) >= TOUCH_FLING_MIN;
+      if (!touchCoasting) touchVelocity = 0;
+    }
+  }
+
+  if (touchCoasting) {
+    unsigned long dt = currentTime - touchSampleMs;
+    touchSampleMs = currentTime;
+    touchPending  += touchVelocity * dt / 1000.0f;
+    touchVelocity -= touchVelocity * min(1.0f, (float)dt / TOUCH_COAST_MS);
+    if (fabsf(touchVelocity) < 1.0f) touchCoasting = false;
+    lastTouchTime = currentTime;  // still scrolling, hold the scroll view
+  }
+
+  int step = 0;
+  if (currentTime - touchFrameMs >= TOUCH_FRAME_MS) {
+    touchFrameMs = currentTime;
+    step = (int)touchPending;  // whole lines, the remainder carries over
+    touchPending -= step;
+  }
+
+  if (!fingerDown && !touchCoasting && lastTouch != -1 && (currentTime - lastTouchTime > TOUCH_TIMEOUT_MS)) {
     // RESET LASTTOUCH AFTER TIMEOUT
     lastTouch = -1;
-    // ONLY UPDATE IF SCROLL HAS CHANGED
-    if (prev_dynamicScroll != dynamicScroll) newLineAdded = true;
+    touchPending = 0;
+    settled = true;
+  }
+  return step;
+}
+
+void updateScrollFromTouch() {
+  bool settled;
+  int step = touchSliderStep(settled);
+
+  int maxScroll = max(0, (int)allLines.size() - maxLines);  // Ensure a valid scroll range
+  if (step != 0) {
+    long target = dynamicScroll + step;
+    dynamicScroll = constrain(target, 0L, (long)maxScroll);
+    if (dynamicScroll != target) touchStop();  // ran into either end
+  }
+
+  // ONLY UPDATE IF SCROLL HAS CHANGED
+  if (settled && prev_dynamicScroll != dynamicScroll) newLineAdded = true;
+}
+
+// Touch and keys for a file open in the read-only viewer
+static void txtViewKB(const KeyEvent& keyEvent, bool hasInput) {
+  static bool touchScrolled = false;
+
+  // SLIDER SCROLLS THE SAME WAY AS IN THE EDITOR, REDRAW ONCE IT SETTLES
+  bool settled;
+  int step = touchSliderStep(settled);
+  if (step != 0) {
+    txtView.scroll(-step, maxLines);
+    touchScrolled = true;
+  }
+  if (settled && touchScrolled) {
+    touchScrolled = false;
+    newLineAdded = true;
+  }
+
+  //No input received
+  if (!hasInput);
+  else if (keyEvent.action == KA_ESC || keyEvent.action == KA_HOME) {
+    txtView.close();
+    CurrentAppState = HOME;
+    currentLine     = "";
+    newState        = true;
+    CurrentKBState  = NORMAL;
+  }
+  // LINE UP / DOWN
+  else if (keyEvent.action == KA_UP) {
+    txtView.scroll(-1, maxLines);
+    newLineAdded = true;
+  }
+  else if (keyEvent.action == KA_DOWN) {
+    txtView.scroll(1, maxLines);
+    newLineAdded = true;
+  }
+  // PAGE UP / DOWN
+  else if (keyEvent.action == KA_LEFT) {
+    txtView.scroll(-(maxLines - 1), maxLines);
+    newLineAdded = true;
+  }
+  else if (keyEvent.action == KA_RIGHT) {
+    txtView.scroll(maxLines - 1, maxLines);
+    newLineAdded = true;
+  }
+  //FILE Received
+  else if (keyEvent.action == KA_FILE) {
+    CurrentTXTState = WIZ0;
+    CurrentKBState = NORMAL;
+    newState = true;
+  }
+  else if (keyEvent.action == KA_CHAR || keyEvent.action == KA_SAVE || keyEvent.action == KA_BACKSPACE) {
+    oledWord("Read Only");
+    delay(300);
+  }
+
+  int currentMillis = millis();
+  //Make sure oled only updates at 60fps
+  if (currentMillis - OLEDFPSMillis >= (1000/60)) {
+    OLEDFPSMillis = currentMillis;
+    oledWord("L:" + String((int)(txtView.topLine() + 1)) + "/" + String((int)(txtView.lineCount())));
   }
 }
\ No newline at end of file
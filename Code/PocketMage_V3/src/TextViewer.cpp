@@ -0,0 +1,254 @@
+#include "globals.h"
+
+// LINE INDEX
+// Each viewed file gets a sidecar TXT_VIEW_DIR/<path with '/' as '_'>.idx:
+//   "LOF1" | file size | file mtime | line offsets (uint32 LE)
+// The line count is implied by the sidecar size.
+#define VIEW_INDEX_MAGIC  "LOF1"
+#define VIEW_INDEX_HEADER 12
+
+static void writeU32(uint8_t* b, uint32_t v) {
+  b[0] = (uint8_t)v;
+  b[1] = (uint8_t)(v >> 8);
+  b[2] = (uint8_t)(v >> 16);
+  b[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t readU32(File& f) {
+  uint32_t v = 0;
+  for (int i = 0; i < 4; i++) v |= (uint32_t)(f.read() & 0xFF) << (8 * i);
+  return v;
+}
+
+bool TextViewer::open(const String& path) {
+  std::lock_guard<std::mutex> guard(lock);
+  closeLocked();
+  filePath = path;
+
+  String name = path.startsWith("/") ? path.substring(1) : path;
+  name.replace("/", "_");
+  indexPath = String(TXT_VIEW_DIR) + "/" + name + ".idx";
+
+  sdCache.flush(path);
+  file = SD_MMC.open(path);
+  if (!file || file.isDirectory()) {
+    Serial.println("Viewer failed to open " + path);
+    return false;
+  }
+  fileSize = file.size();
+
+  if (!indexIsCurrent() && !buildIndex()) {
+    file.close();
+    return false;
+  }
+
+  index = SD_MMC.open(indexPath);
+  if (!index) {
+    file.close();
+    return false;
+  }
+  count = (index.size() - VIEW_INDEX_HEADER) / 4;
+
+  setTXTFont(currentFont);
+  opened = true;
+  return true;
+}
+
+void TextViewer::close() {
+  std::lock_guard<std::mutex> guard(lock);
+  closeLocked();
+}
+
+void TextViewer::closeLocked() {
+  if (opened) {
+    file.close();
+    index.close();
+  }
+  opened = false;
+  window.clear();
+  winFirst = winEnd = 0;
+  top = 0;
+  count = 0;
+}
+
+bool TextViewer::indexIsCurrent() {
+  File idx = SD_MMC.open(indexPath);
+  if (!idx) return false;
+
+  char magic[4];
+  for (int i = 0; i < 4; i++) magic[i] = idx.read();
+  size_t idxSize = idx.size();
+  bool ok = memcmp(magic, VIEW_INDEX_MAGIC, 4) == 0 &&
+            readU32(idx) == fileSize &&
+            readU32(idx) == (uint32_t)file.getLastWrite() &&
+            idxSize > VIEW_INDEX_HEADER && (idxSize - VIEW_INDEX_HEADER) % 4 == 0;
+  idx.close();
+  return ok;
+}
+
+// One streaming pass over the file, offsets are batched into a small buffer.
+// Written to a temp file first so an interrupted build never looks current.
+bool TextViewer::buildIndex() {
+  oledWord("Indexing File");
+
+  if (!SD_MMC.exists(TXT_VIEW_DIR)) SD_MMC.mkdir(TXT_VIEW_DIR);
+  String tmpPath = indexPath + ".tmp";
+  if (SD_MMC.exists(tmpPath)) SD_MMC.remove(tmpPath);
+  File out = SD_MMC.open(tmpPath, FILE_WRITE);
+  if (!out) {
+    Serial.println("Failed to write viewer index");
+    return false;
+  }
+
+  uint8_t buf[256];
+  size_t used = 0;
+  memcpy(buf, VIEW_INDEX_MAGIC, 4);
+  writeU32(buf + 4, fileSize);
+  writeU32(buf + 8, file.getLastWrite());
+  writeU32(buf + 12, 0);  // line 0
+  used = 16;
+
+  file.seek(0);
+  uint8_t block[FILE_IO_CHUNK];
+  uint32_t lineStart = 0;
+  uint32_t pos = 0;
+  while (pos < fileSize) {
+    size_t n = file.read(block, sizeof(block));
+    if (n == 0) break;
+
+    for (size_t i = 0; i < n; i++, pos++) {
+      uint8_t c = block[i];
+      uint32_t next = 0;
+      if (c == '\n') next = pos + 1;
+      // Split overlong lines, but never inside a UTF-8 character
+      else if (pos - lineStart >= TXT_VIEW_MAX_LINE && (c & 0xC0) != 0x80) next = pos;
+      if (next == 0 || next >= fileSize) continue;
+
+      lineStart = next;
+      if (used + 4 > sizeof(buf)) {
+        out.write(buf, used);
+        used = 0;
+      }
+      writeU32(buf + used, next);
+      used += 4;
+    }
+  }
+  out.write(buf, used);
+  out.close();
+
+  if (SD_MMC.exists(indexPath)) SD_MMC.remove(indexPath);
+  return SD_MMC.rename(tmpPath, indexPath);
+}
+
+uint32_t TextViewer::lineOffset(uint32_t line) {
+  if (line >= count) return fileSize;
+  index.seek(VIEW_INDEX_HEADER + line * 4);
+  return readU32(index);
+}
+
+String TextViewer::readLine(uint32_t line) {
+  uint32_t start = lineOffset(line);
+  uint32_t end   = lineOffset(line + 1);
+
+  String text = "";
+  text.reserve(end - start);
+  file.seek(start);
+
+  char block[FILE_IO_CHUNK];
+  for (uint32_t left = end - start; left > 0;) {
+    size_t n = file.read((uint8_t*)block, std::min<uint32_t>(left, sizeof(block)));
+    if (n == 0) break;
+    text.concat(block, n);
+    left -= n;
+  }
+
+  // Drop the line ending
+  while (text.length() > 0 && (text[text.length() - 1] == '\n' || text[text.length() - 1] == '\r')) {
+    text.remove(text.length() - 1);
+  }
+  return text;
+}
+
+// WINDOW
+void TextViewer::wrapLine(uint32_t line, std::vector<Row>& rows) {
+  std::vector<String> text;
+  std::vector<uint32_t> starts;
+  txtWrapParagraph(readLine(line), 0, text, starts);
+  for (const String& t : text) rows.push_back({t, line});
+}
+
+void TextViewer::pushFront() {
+  if (winFirst == 0) return;
+  std::vector<Row> rows;
+  wrapLine(--winFirst, rows);
+  window.insert(window.begin(), rows.begin(), rows.end());
+  top += rows.size();
+}
+
+void TextViewer::pushBack() {
+  if (winEnd >= count) return;
+  std::vector<Row> rows;
+  wrapLine(winEnd++, rows);
+  window.insert(window.end(), rows.begin(), rows.end());
+}
+
+// Drop whole lines that are more than a screen away from the viewport
+void TextViewer::trim(long viewRows) {
+  while (winFirst < winEnd) {
+    long n = 0;
+    while (n < (long)window.size() && window[n].line == winFirst) n++;
+    if (top - n < viewRows) break;
+    window.erase(window.begin(), window.begin() + n);
+    top -= n;
+    winFirst++;
+  }
+  while (winFirst < winEnd) {
+    long n = 0;
+    while (n < (long)window.size() && window[window.size() - 1 - n].line == winEnd - 1) n++;
+    if ((long)window.size() - n < top + 2 * viewRows) break;
+    window.erase(window.end() - n, window.end());
+    winEnd--;
+  }
+}
+
+void TextViewer::scroll(long rows, long viewRows) {
+  std::lock_guard<std::mutex> guard(lock);
+  if (!opened) return;
+
+  top += rows;
+  while (top < 0 && winFirst > 0) pushFront();
+  while ((long)window.size() < top + viewRows && winEnd < count) pushBack();
+
+  // Past the end of the file, pull back so the screen stays full
+  if (top + viewRows > (long)window.size()) top = window.size() - viewRows;
+  while (top < 0 && winFirst > 0) pushFront();
+  if (top < 0) top = 0;
+
+  trim(viewRows);
+}
+
+void TextViewer::visibleRows(std::vector<String>& out, long viewRows) const {
+  std::lock_guard<std::mutex> guard(lock);
+  out.clear();
+  for (long i = top; i < (long)window.size() && i < top + viewRows; i++) out.push_back(window[i].text);
+}
+
+bool TextViewer::isOpen() const {
+  std::lock_guard<std::mutex> guard(lock);
+  return opened;
+}
+
+uint32_t TextViewer::lineCount() const {
+  std::lock_guard<std::mutex> guard(lock);
+  return count;
+}
+
+uint32_t TextViewer::topLine() const {
+  std::lock_guard<std::mutex> guard(lock);
+  return window.empty() ? 0 : window[top].line;
+}
+
+String TextViewer::path() const {
+  std::lock_guard<std::mutex> guard(lock);
+  return filePath;
+}
@@ -0,0 +1,42 @@
+#include "globals.h"
+
+void TimeService::syncLocked() {
+  baseUnix   = rtc.now().unixtime();
+  baseMillis = millis();
+  synced     = true;
+}
+
+void TimeService::sync() {
+  std::lock_guard<std::mutex> guard(lock);
+  syncLocked();
+}
+
+void TimeService::set(const DateTime& t) {
+  std::lock_guard<std::mutex> guard(lock);
+  rtc.adjust(t);
+  syncLocked();
+}
+
+uint32_t TimeService::unixtime() {
+  std::lock_guard<std::mutex> guard(lock);
+  if (!synced || millis() - baseMillis >= TIME_RESYNC_MS) syncLocked();
+  return baseUnix + (millis() - baseMillis) / 1000;
+}
+
+DateTime TimeService::now() {
+  return DateTime(unixtime());
+}
+
+bool TimeService::minuteChanged(uint32_t& seen) {
+  uint32_t minute = unixtime() / 60;
+  if (minute == seen) return false;
+  seen = minute;
+  return true;
+}
+
+bool TimeService::secondChanged(uint32_t& seen) {
+  uint32_t second = unixtime();
+  if (second == seen) return false;
+  seen = second;
+  return true;
+}
@@ -13,33 +13,43 @@ void USB_INIT() {
   newState = true;
 }
 
+// Raw card access for mscCache, whole runs of sectors per command
+class SdmmcBlockDevice : public BlockDevice {
+public:
+  uint32_t sectorSize() override  { return card ? card->csd.sector_size : 0; }
+  uint32_t sectorCount() override { return card ? card->csd.capacity : 0; }
+  bool readSectors(uint8_t* dst, uint32_t lba, uint32_t count) override {
+    return sdmmc_read_sectors(card, dst, lba, count) == ESP_OK;
+  }
+  bool writeSectors(const uint8_t* src, uint32_t lba, uint32_t count) override {
+    return sdmmc_write_sectors(card, src, lba, count) == ESP_OK;
+  }
+  uint8_t* allocBuffer(size_t bytes) override {
+    return (uint8_t*)heap_caps_malloc(bytes, MALLOC_CAP_DMA);
+  }
+  void freeBuffer(uint8_t* buf) override { heap_caps_free(buf); }
+};
+static SdmmcBlockDevice sdBlocks;
+
 static int32_t onWrite(uint32_t lba, uint32_t offset, uint8_t* buffer, uint32_t bufsize) {
   SDActive = true;
-  if (!card || card->csd.sector_size == 0) return -1;
-  uint32_t secSize = card->csd.sector_size;
-  for (uint32_t i = 0; i < bufsize / secSize; ++i) {
-    esp_err_t err = sdmmc_write_sectors(card, buffer + i * secSize, lba + i, 1);
-    if (err != ESP_OK) return -1;
-  }
+  int32_t result = mscCache.write(lba, buffer, bufsize);
   SDActive = false;
-  return bufsize;
+  return result;
 }
 
 static int32_t onRead(uint32_t lba, uint32_t offset, void* buffer, uint32_t bufsize) {
   SDActive = true;
-  if (!card || card->csd.sector_size == 0) return -1;
-  uint32_t secSize = card->csd.sector_size;
-  for (uint32_t i = 0; i < bufsize / secSize; ++i) {
-    esp_err_t err = sdmmc_read_sectors(card, (uint8_t*)buffer + i * secSize, lba + i, 1);
-    if (err != ESP_OK) return -1;
-  }
+  int32_t result = mscCache.read(lba, (uint8_t*)buffer, bufsize);
   SDActive = false;
-  return bufsize;
+  return result;
 }
 
 static bool onStartStop(uint8_t power_condition, bool start, bool eject) {
   SDActive = true;
   Serial.printf("MSC Start/Stop: power=%u, start=%d, eject=%d\n", power_condition, start, eject);
+  // The host is done with the card, nothing may stay buffered
+  if (!start || eject) mscCache.flush();
   SDActive = false;
   return true;
 }
@@ -59,38 +69,55 @@ static void usbEventCallback(void* arg, esp_event_base_t event_base, int32_t eve
 }
 
 void USBAppSetup() {
+  if (mscEnabled) return;
+
   oledWord("Initializing USB");
-  setCpuFrequencyMhz(240);
+  // Full speed for the whole session, USBAppShutdown() unpins it
+  IoBoostSession::pin();
   delay(50);
 
   disableTimeout = true;
 
-  if (mscEnabled) return;
+  // The host owns the card from here on
+  ioWorker.drain();
+  sdCache.flushAll();
 
   Serial.println("Unmounting SD_MMC for USB MSC...");
   SD_MMC.end();  // unmount FS before raw access
 
-  // Configure SDMMC host and slot manually
+  // Configure SDMMC host and slot manually, at the same clock SD_MMC mounts
+  // with, and 4 bits wide when D1-D3 are routed
   sdmmc_host_t host = SDMMC_HOST_DEFAULT();
+  host.max_freq_khz = SDMMC_FREQ_HIGHSPEED;
   sdmmc_slot_config_t slot_config = SDMMC_SLOT_CONFIG_DEFAULT();
   slot_config.clk = (gpio_num_t)SD_CLK;
   slot_config.cmd = (gpio_num_t)SD_CMD;
   slot_config.d0 = (gpio_num_t)SD_D0;
-  slot_config.d1 = (gpio_num_t)0;
-  slot_config.d2 = (gpio_num_t)0;
-  slot_config.d3 = (gpio_num_t)0;
-  slot_config.width = 1;  // or 4 for 4-bit mode
+  if (SD_D1 >= 0 && SD_D2 >= 0 && SD_D3 >= 0) {
+    slot_config.d1 = (gpio_num_t)SD_D1;
+    slot_config.d2 = (gpio_num_t)SD_D2;
+    slot_config.d3 = (gpio_num_t)SD_D3;
+    slot_config.width = 4;
+  }
+  else {
+    slot_config.d1 = (gpio_num_t)0;
+    slot_config.d2 = (gpio_num_t)0;
+    slot_config.d3 = (gpio_num_t)0;
+    slot_config.width = 1;
+  }
 
   // Initialize host
   esp_err_t err = sdmmc_host_init();
   if (err != ESP_OK) {
     Serial.printf("Host init failed: %s\n", esp_err_to_name(err));
+    IoBoostSession::unpin();
     return;
   }
 
   err = sdmmc_host_init_slot(SDMMC_HOST_SLOT_1, &slot_config);
   if (err != ESP_OK) {
     Serial.printf("Slot init failed: %s\n", esp_err_to_name(err));
+    IoBoostSession::unpin();
     return;
   }
 
@@ -98,6 +125,7 @@ void USBAppSetup() {
   card = (sdmmc_card_t*)malloc(sizeof(sdmmc_card_t));
   if (!card) {
     Serial.println("Failed to allocate card struct");
+    IoBoostSession::unpin();
     return;
   }
 
@@ -106,9 +134,12 @@ void USBAppSetup() {
     Serial.printf("Card init failed: %s\n", esp_err_to_name(err));
     free(card);
     card = nullptr;
+    IoBoostSession::unpin();
     return;
   }
 
+  mscCache.begin(&sdBlocks);
+
   // Setup USB MSC
   Serial.println("Initializing USB MSC...");
   msc.vendorID("ESP32");
@@ -138,6 +169,7 @@ void USBAppShutdown() {
 
   // Stop MSC functionality
   msc.end();
+  mscCache.end();
 
   // Free card struct
   if (card) {
@@ -178,12 +210,23 @@ void USBAppShutdown() {
   if (!SD_MMC.exists("/sys"))     SD_MMC.mkdir("/sys");
   if (!SD_MMC.exists("/journal")) SD_MMC.mkdir("/journal");
 
-  if (SAVE_POWER) setCpuFrequencyMhz(POWER_SAVE_FREQ);
+  // The host may have changed /journal, the metadata log, the tasks or any
+  // other file, rebuild their indexes on next use
+  invalidateJournalIndex();
+  invalidateMetadataIndex();
+  invalidateTaskArray();
+  sdIndex.invalidate();
+  prefetchDirIndex();
+
+  IoBoostSession::unpin();
+  IoBoostSession::release();
 
   disableTimeout = false;
 }
 
 void processKB_USB() {
+  mscCache.idle();
+
   int currentMillis = millis();
   //Make sure oled only updates at 10FPS
   if (currentMillis - OLEDFPSMillis >= (1000/10 /*OLED_MAX_FPS*/)) {
@@ -208,8 +251,7 @@ void processKB_USB() {
 }
 
 void einkHandler_USB() {
-  if (newState) {
-    newState = false;
+  if (newState.take()) {
     
     display.fillScreen(GxEPD_WHITE);
 
@@ -12,20 +12,37 @@
 U8G2_FOR_ADAFRUIT_GFX u8g2Gfx;
 
 void refresh() {
-  // USE A SLOW FULL UPDATE EVERY N FAST UPDATES OR WHEN SPECIFIED
-  if ((partialCounter >= FULL_REFRESH_AFTER) || forceSlowFullUpdate) {
+  // DIFF THE FRAME AGAINST WHAT THE PANEL SHOWS
+  EinkRect damaged = display.damage();
+  long damagedArea = (long)damaged.w * damaged.h;
+  long screenArea  = (long)display.width() * display.height();
+
+  // SLOW FULL UPDATE WHEN A TILE'S FAST-FULL RESIDUE IS OVER BUDGET, WHEN SPECIFIED
+  // OR WHEN THE PANEL STATE IS UNKNOWN
+  if (forceSlowFullUpdate || !display.shownValid() || display.fullResidue() >= EINK_GHOST_SLOW_BUDGET) {
     forceSlowFullUpdate = false;
-    partialCounter = 0;
     setFastFullRefresh(false);
+    display.display(false);
   }
-  // OTHERWISE USE A FAST FULL UPDATE
+  // CALLER SET UP ITS OWN PARTIAL WINDOW
+  else if (display.inPartialWindow()) {
+    setFastFullRefresh(true);
+    display.display(false);
+  }
+  // NOTHING CHANGED
+  else if (damagedArea == 0) {
+  }
+  // SMALL CHANGE ON TILES WITH GHOSTING BUDGET LEFT, PARTIAL REFRESH OF THE DAMAGED AREA ONLY
+  else if (damagedArea * 100 <= screenArea * EINK_PARTIAL_MAX_AREA &&
+           display.partialGhostWith(damaged) < EINK_GHOST_PARTIAL_BUDGET) {
+    display.displayWindow(damaged.x, damaged.y, damaged.w, damaged.h);
+  }
+  // OTHERWISE A FAST FULL UPDATE
   else {
     setFastFullRefresh(true);
-    partialCounter++;
+    display.display(false);
   }
 
-  display.display(false);
-
   display.setFullWindow();
   display.fillScreen(GxEPD_WHITE);
   display.hibernate();
@@ -63,7 +80,8 @@ void einkHandler(void* parameter) {
   while (true) {
     applicationEinkHandler();
 
-    vTaskDelay(50 / portTICK_PERIOD_MS);
+    // Sleep until loop() posts a render request
+    renderQueue.wait(renderQueue.take(RENDER_RETRY) ? EINK_RETRY_MS : EINK_IDLE_WAKE_MS);
     yield();
   }
 }
@@ -215,6 +233,45 @@ void einkTextPartial(String text, bool noRefresh) {
   }
 }
 
+// Draw the TXT editor caret if it sits on this row (y = row baseline)
+static void drawTextCursor(long line, int y) {
+  if (CurrentAppState != TXT || line != cursorLine || line >= (long)lineStarts.size()) return;
+
+  int16_t x1, y1;
+  uint16_t w, h;
+  size_t col = txtCursor - lineStarts[line];
+  getTextBoundsUTF8(allLines[line].substring(0, col), 0, 0, &x1, &y1, &w, &h);
+  display.drawFastVLine(w, y - fontHeight + 2, fontHeight + 2, GxEPD_BLACK);
+}
+
+// Repaint a single row of the dynamic text view with a partial refresh
+void einkTextLine(long line) {
+  setTXTFont(currentFont);
+
+  long size = allLines.size();
+  long displayLines = maxLines;
+  if (displayLines > size) displayLines = size;
+
+  long scrollOffset = dynamicScroll;
+  if (scrollOffset < 0) scrollOffset = 0;
+  if (scrollOffset > size - displayLines) scrollOffset = size - displayLines;
+
+  long firstLine = size - displayLines - scrollOffset;
+  if (line < firstLine || line >= firstLine + displayLines) return;
+
+  int top = (fontHeight + lineSpacing) * (line - firstLine);
+  display.setPartialWindow(0, top, display.width(), fontHeight + lineSpacing);
+  display.fillRect(0, top, display.width(), fontHeight + lineSpacing, GxEPD_WHITE);
+  setCursorUTF8(0, fontHeight + top);
+  printUTF8(allLines[line]);
+  drawTextCursor(line, fontHeight + top);
+
+  display.display(true);
+  display.setFullWindow();
+  display.fillScreen(GxEPD_WHITE);
+  display.hibernate();
+}
+
 void einkTextDynamic(bool doFull_, bool noRefresh) {
   std::cout << "[POCKETMAGE] einkTextDynamic() called - doFull_=" << doFull_ << ", noRefresh=" << noRefresh << std::endl;
   std::cout << "[POCKETMAGE] allLines.size()=" << allLines.size() << ", allText='" << allText.c_str() << "'" << std::endl;
@@ -222,13 +279,13 @@ void einkTextDynamic(bool doFull_, bool noRefresh) {
   setTXTFont(currentFont);
 
   // ITERATE AND DISPLAY
-  uint8_t size = allLines.size();
-  uint8_t displayLines = maxLines;
+  long size = allLines.size();
+  long displayLines = maxLines;
 
   if (displayLines > size) displayLines = size;  // PREVENT OUT OF BOUNDS
 
   // Apply dynamic scroll offset (make sure it's within the bounds)
-  int scrollOffset = dynamicScroll;
+  long scrollOffset = dynamicScroll;
   if (scrollOffset < 0) scrollOffset = 0;
   if (scrollOffset > size - displayLines) scrollOffset = size - displayLines;
 
@@ -238,19 +295,20 @@ void einkTextDynamic(bool doFull_, bool noRefresh) {
     display.fillScreen(GxEPD_WHITE);
     
     // If no content, show a cursor or placeholder
-    if (size == 0 || allText.length() == 0) {
+    if (size == 0 || (size == 1 && allLines[0].length() == 0)) {
       std::cout << "[POCKETMAGE] No content - drawing cursor/placeholder" << std::endl;
       display.setFullWindow();
       setCursorUTF8(0, fontHeight);
       printUTF8("_");  // Show cursor
     } else {
       std::cout << "[POCKETMAGE] Drawing " << size << " lines of text" << std::endl;
-      for (uint8_t i = size - displayLines - scrollOffset; i < size - scrollOffset; i++) {
-        if ((allLines[i]).length() > 0) {
+      for (long i = size - displayLines - scrollOffset; i < size - scrollOffset; i++) {
+        if ((allLines[i]).length() > 0 || i == cursorLine) {
           display.setFullWindow();
           //display.fillRect(0, (fontHeight + lineSpacing) * (i - (size - displayLines - scrollOffset)), display.width(), (fontHeight + lineSpacing), GxEPD_WHITE);
           setCursorUTF8(0, fontHeight + ((fontHeight + lineSpacing) * (i - (size - displayLines - scrollOffset))));
           printUTF8(allLines[i]);
+          drawTextCursor(i, fontHeight + ((fontHeight + lineSpacing) * (i - (size - displayLines - scrollOffset))));
           std::cout << "[POCKETMAGE] Drew line " << i << ": '" << allLines[i].c_str() << "'" << std::endl;
           Serial.println(allLines[i]);
         }
@@ -270,6 +328,24 @@ void einkTextDynamic(bool doFull_, bool noRefresh) {
   drawStatusBar("L:" + String(allLines.size()) + " " + editingFile);
 }
 
+// Draw the rows on screen in the read-only viewer
+void einkTextView() {
+  setTXTFont(currentFont);
+  std::vector<String> rows;
+  txtView.visibleRows(rows, maxLines);
+
+  display.setFullWindow();
+  display.fillScreen(GxEPD_WHITE);
+  for (size_t i = 0; i < rows.size(); i++) {
+    if (rows[i].length() == 0) continue;
+    setCursorUTF8(0, fontHeight + ((fontHeight + lineSpacing) * i));
+    printUTF8(rows[i]);
+  }
+
+  drawStatusBar("L:" + String((int)(txtView.topLine() + 1)) + "/" +
+                String((int)(txtView.lineCount())) + " " + txtView.path());
+}
+
 int countLines(String input, size_t maxLineLength) {
   size_t inputLength = input.length();
   uint8_t charCounter = 0;
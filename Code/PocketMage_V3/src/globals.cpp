@@ -13,7 +13,7 @@
 //  8""88888P'  o888ooooood8     o888o        `YbodP'    o888o         //
 
 // Display setup
-GxEPD2_BW<GxEPD2_310_GDEQ031T10, GxEPD2_310_GDEQ031T10::HEIGHT> display(GxEPD2_310_GDEQ031T10(EPD_CS, EPD_DC, EPD_RST, EPD_BUSY));
+EinkCompositor display(GxEPD2_310_GDEQ031T10(EPD_CS, EPD_DC, EPD_RST, EPD_BUSY));
 volatile bool GxEPD2_310_GDEQ031T10::useFastFullUpdate = true;
 U8G2_SSD1326_ER_256X32_F_4W_HW_SPI u8g2(U8G2_R2, OLED_CS, OLED_DC, OLED_RST); //256x32
 
@@ -49,12 +49,14 @@ Adafruit_MPR121 cap = Adafruit_MPR121();
 
 // RTC setup
 RTC_PCF8563 rtc;
+TimeService timeService;
 const char daysOfTheWeek[7][12] = { "Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday" };
 
 // USB
 USBMSC msc;
 bool mscEnabled = false;
 sdmmc_card_t* card = nullptr;
+MscCache mscCache;
 
 // VARIABLES
 // GENERAL
@@ -75,22 +77,24 @@ int KBBounceMillis = 0;
 volatile int timeoutMillis = 0;
 volatile int prevTimeMillis = 0;
 volatile bool TCA8418_event = false;
+KeyQueue keyQueue;
 volatile bool PWR_BTN_event = false;
+volatile bool MPR121_event = false;
 volatile bool SHFT = false;
 volatile bool FN = false;
-volatile bool newState = false;
+RenderQueue renderQueue(RENDER_LINE);
+RenderFlag newState(RENDER_STATE);
 bool noTimeout = false;
 volatile bool OLEDPowerSave = false;
 volatile bool disableTimeout = false;
 volatile int battState = 0;
 volatile int prevBattState = 0;
 unsigned int flashMillis = 0;
-int prevTime = 0;
+uint32_t prevTime = UINT32_MAX;
 uint8_t prevSec = 0;
 TaskHandle_t einkHandlerTaskHandle = NULL;
 char currentKB[4][10];
 KBState CurrentKBState = NORMAL;
-uint8_t partialCounter = 0;
 volatile bool forceSlowFullUpdate = false;
 volatile bool SDCARD_INSERT = false;
 bool noSD = false;
@@ -113,6 +117,11 @@ String outLines[13];
 String lines_prev[13];
 String filesList[MAX_FILES];
 uint8_t fileIndex = 0;
+uint16_t filesPage = 0;
+uint16_t filesPageCount = 1;
+DirIndex sdIndex;
+SdCache sdCache;
+IoWorker ioWorker;
 String editingFile;
 String prevEditingFile = "";
 String excludedFiles[3] = { "/temp.txt", "/settings.txt", "/tasks.txt" };
@@ -124,16 +133,22 @@ uint8_t maxCharsPerLine = 0;
 uint8_t maxLines = 0;
 uint8_t fontHeight = 0;
 uint8_t lineSpacing = 6;  // LINE SPACING IN PIXELS
-volatile bool newLineAdded = true;
-volatile bool doFull = false;
+RenderFlag newLineAdded(RENDER_LINE);
+RenderFlag doFull(RENDER_FULL);
 std::vector<String> allLines;
 volatile long int dynamicScroll = 0;
 volatile long int prev_dynamicScroll = 0;
 int lastTouch = -1;
 unsigned long lastTouchTime = 0;
+PieceTable txtDoc;
+size_t txtCursor = 0;
+RowIndex lineStarts;
+volatile long cursorLine = 0;
+RenderFlag cursorMoved(RENDER_CURSOR);
+TextViewer txtView;
 
 // <TASKS.cpp>
-std::vector<std::vector<String>> tasks;
+std::vector<Task> tasks;
 uint8_t selectedTask = 0;
 TasksState CurrentTasksState = TASKS0;
 uint8_t newTaskState = 0;
@@ -165,7 +180,7 @@ PokedexState CurrentPokedexState = POKE_LIST;
 
 // UTF-8 Keyboard Layout System
 KeyboardLayout CurrentLayout;
-std::vector<DeadRule> DeadTable;
+CompiledLayout ActiveLayout;
 String CurrentDead = "";
 String CurrentLayoutName = "us-latin"; // default; persisted in Preferences
 
@@ -216,27 +231,9 @@ void initializeFallbackLayout() {
   // No dead keys in fallback layout
   CurrentLayout.deadKeys.clear();
   
+  std::vector<uint8_t> blob = compileKeyboardLayout(CurrentLayout);
+  ActiveLayout.adopt(blob);
+
   // Mirror to legacy arrays
   mirrorLayoutToLegacy();
 }
-
-// Dead-key composition (data-driven)
-String composeDeadIfAny(const String& base) {
-  if (CurrentDead.length() == 0) return base;
-  
-  std::cout << "[DEAD] Looking for accent: '" << CurrentDead.c_str() << "' + base: '" << base.c_str() << "'" << std::endl;
-  std::cout << "[DEAD] DeadTable size: " << DeadTable.size() << std::endl;
-  
-  for (const auto& r : DeadTable) {
-    std::cout << "[DEAD] Checking rule: '" << r.accent.c_str() << "' + '" << r.base.c_str() << "' -> '" << r.out.c_str() << "'" << std::endl;
-    if (r.accent == CurrentDead && r.base == base) {
-      CurrentDead = "";
-      std::cout << "[DEAD] Match found! Returning: '" << r.out.c_str() << "'" << std::endl;
-      return r.out;
-    }
-  }
-  // fallback: just emit the base character (no accent found)
-  std::cout << "[DEAD] No match found, returning base character: '" << base.c_str() << "'" << std::endl;
-  CurrentDead = "";
-  return base;
-}
\ No newline at end of file
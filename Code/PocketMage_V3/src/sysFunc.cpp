@@ -6,104 +6,205 @@
 //  oo     .d8P      888      oo     .d8P      888       888       o  8    Y     888   //
 //  8""88888P'      o888o     8""88888P'      o888o     o888ooooood8 o8o        o888o  //
 #include "globals.h"
+#include "GlyphAdvance.h"
 #include <ArduinoJson.h>
+#include <memory>
+#include "esp_rom_crc.h"
+#include <unordered_map>
 
 // High-Level File Operations
 void saveFile() {
+  // The paged viewer is read-only and txtDoc doesn't hold the file
+  if (CurrentAppState == TXT && txtView.isOpen()) return;
+
   if (noSD) {
     oledWord("SAVE FAILED - No SD!");
     delay(5000);
     return;
   }
   else {
-    SDActive = true;
-    setCpuFrequencyMhz(240);
-    delay(50);
-
-    String textToSave = vectorToString();
+    // The TXT editor keeps its text in the piece table, other apps in allLines.
+    // The snapshot is written by the I/O worker so typing carries on meanwhile.
+    std::shared_ptr<String> textToSave = std::make_shared<String>((CurrentAppState == TXT) ? txtDoc.toString() : vectorToString());
     if (DEBUG_VERBOSE) {
       Serial.println("Text to save:");
-      Serial.println(textToSave);
+      Serial.println(*textToSave);
     }
     if (editingFile == "" || editingFile == "-") editingFile = "/temp.txt";
-    keypad.disableInterrupts();
     if (!editingFile.startsWith("/")) editingFile = "/" + editingFile;
-    oledWord("Saving File: "+ editingFile);
-    writeFile(SD_MMC, (editingFile).c_str(), textToSave.c_str());
-    oledWord("Saved: "+ editingFile);
+    String path = editingFile;
+    oledWord("Saving File: "+ path);
+
+    ioWorker.submit(
+      [path, textToSave]() {
+        IoBoostSession ioBoost;
+        bool ok = writeFile(SD_MMC, path.c_str(), textToSave->c_str());
+
+        // Write MetaData
+        if (ok) writeMetadata(path, textToSave->length(), countVisibleChars(*textToSave));
+        sdCache.flushAll();
+        return ok;
+      },
+      [path](bool ok) {
+        oledWord(ok ? "Saved: " + path : "SAVE FAILED: " + path);
+      });
+  }
+}
 
-    // Write MetaData
-    writeMetadata(editingFile);
-    
-    delay(1000);
-    keypad.enableInterrupts();
-    if (SAVE_POWER) setCpuFrequencyMhz(POWER_SAVE_FREQ);
-    SDActive = false;
+// METADATA STORE
+// SYS_METADATA_FILE is an append-only log of "path|timestamp|size Bytes|count Char"
+// records. The last record for a path wins and "path|-" marks a deletion. The
+// log is replayed into a hash index once, each update appends a single line,
+// and the file is rewritten with only the live records once dead ones pile up.
+struct MetaEntry {
+  String   stamp;
+  uint32_t bytes;
+  int      chars;
+};
+static std::unordered_map<std::string, MetaEntry> metaIndex;
+static bool     metaLoaded = false;
+static uint32_t metaDeadRecords = 0;
+
+static String metaRecord(const String& path, const MetaEntry& e) {
+  return path + "|" + e.stamp + "|" + String(static_cast<unsigned long>(e.bytes)) + " Bytes|" + String(e.chars) + " Char";
+}
+
+static void appendMetaLine(const String& line) {
+  String record = line + "\r\n";
+  if (sdCache.append(SYS_METADATA_FILE, record.c_str(), record.length())) return;
+
+  File metaFile = SD_MMC.open(SYS_METADATA_FILE, FILE_APPEND);
+  if (!metaFile) {
+    Serial.println("Failed to open metadata file for writing.");
+    return;
   }
+  metaFile.println(line);
+  metaFile.close();
 }
 
-void writeMetadata(const String& path) {
-  File file = SD_MMC.open(path);
-  if (!file || file.isDirectory()) {
-    Serial.println("Invalid file for metadata.");
+static void compactMetadata() {
+  const char* tmpPath = "/sys/SDMMC_META.tmp";
+  File out = SD_MMC.open(tmpPath, FILE_WRITE);
+  if (!out) {
+    Serial.println("Failed to compact metadata.");
     return;
   }
+  // Queued records are already in metaIndex
+  sdCache.discard(SYS_METADATA_FILE);
+  for (const auto& kv : metaIndex) {
+    out.println(metaRecord(String(kv.first.c_str()), kv.second));
+  }
+  out.close();
 
-  // Get file size
-  size_t fileSizeBytes = file.size();
-  file.close();
+  SD_MMC.remove(SYS_METADATA_FILE);
+  SD_MMC.rename(tmpPath, SYS_METADATA_FILE);
+  metaDeadRecords = 0;
+  Serial.println("Metadata compacted.");
+}
 
-  // Format size string
-  String fileSizeStr = String(static_cast<unsigned long>(fileSizeBytes)) + " Bytes";
+static void loadMetadataIndex() {
+  if (metaLoaded) return;
+  metaLoaded = true;
+  metaIndex.clear();
+  metaDeadRecords = 0;
+
+  sdCache.flush(SYS_METADATA_FILE);
+  File metaFile = SD_MMC.open(SYS_METADATA_FILE, FILE_READ);
+  if (!metaFile) return;
+
+  SdLineReader reader(metaFile);
+  String line;
+  while (reader.readLine(line)) {
+    line.trim();
+    int sep = line.indexOf('|');
+    if (sep <= 0) continue;
+
+    std::string key = line.substring(0, sep).c_str();
+    if (metaIndex.count(key)) metaDeadRecords++;
+
+    String rest = line.substring(sep + 1);
+    if (rest == "-") {
+      metaIndex.erase(key);
+      metaDeadRecords++;
+      continue;
+    }
 
-  // Get line and char counts
-  int charCount = countVisibleChars(readFileToString(SD_MMC, path.c_str()));
+    int sizeSep = rest.indexOf('|');
+    int charSep = rest.indexOf('|', sizeSep + 1);
+    if (sizeSep == -1 || charSep == -1) continue;
 
-  String charStr  = String(charCount) + " Char";
+    MetaEntry e;
+    e.stamp = rest.substring(0, sizeSep);
+    e.bytes = rest.substring(sizeSep + 1, charSep).toInt();
+    e.chars = rest.substring(charSep + 1).toInt();
+    metaIndex[key] = e;
+  }
+  metaFile.close();
 
-  // Get current time from RTC
-  DateTime now = rtc.now();
+  if (metaDeadRecords > metaIndex.size() + META_COMPACT_SLACK) compactMetadata();
+}
+
+// Appends a record and compacts once dead records outnumber the live ones
+static void putMetadata(const String& path, const MetaEntry& e) {
+  std::string key = path.c_str();
+  if (metaIndex.count(key)) metaDeadRecords++;
+  metaIndex[key] = e;
+  appendMetaLine(metaRecord(path, e));
+
+  if (metaDeadRecords > metaIndex.size() + META_COMPACT_SLACK) compactMetadata();
+}
+
+static String metaTimestamp() {
+  DateTime now = timeService.now();
   char timestamp[20];
   sprintf(timestamp, "%04d%02d%02d-%02d%02d",
           now.year(), now.month(), now.day(), now.hour(), now.minute());
+  return String(timestamp);
+}
 
-  // Compose new metadata line
-  String newEntry = path + "|" + timestamp + "|" + fileSizeStr + "|" + charStr;
+void invalidateMetadataIndex() {
+  metaLoaded = false;
+  metaIndex.clear();
+}
 
-  const char* metaPath = SYS_METADATA_FILE;
+// Size and visible character count come from the caller, which already has
+// the text in memory
+void writeMetadata(const String& path, size_t fileSizeBytes, int charCount) {
+  loadMetadataIndex();
 
-  // Read existing entries and rebuild the file without duplicates
-  File metaFile = SD_MMC.open(metaPath, FILE_READ);
-  String updatedMeta = "";
-  bool replaced = false;
+  MetaEntry e;
+  e.stamp = metaTimestamp();
+  e.bytes = fileSizeBytes;
+  e.chars = charCount;
+  putMetadata(path, e);
 
-  if (metaFile) {
-    while (metaFile.available()) {
-      String line = metaFile.readStringUntil('\n');
-      if (line.startsWith(path + "|")) {
-        updatedMeta += newEntry + "\n";
-        replaced = true;
-      } else if (line.length() > 1) {
-        updatedMeta += line + "\n";
-      }
-    }
-    metaFile.close();
-  }
+  Serial.println("Metadata updated.");
+}
 
-  if (!replaced) {
-    updatedMeta += newEntry + "\n";
-  }
+// Grows an existing record by the appended text. Only a file without a record
+// yet is read back to count its characters.
+void appendMetadata(const String& path, size_t bytesAdded, int charsAdded) {
+  loadMetadataIndex();
 
-  // Write back the updated metadata
-  metaFile = SD_MMC.open(metaPath, FILE_WRITE);
-  if (!metaFile) {
-    Serial.println("Failed to open metadata file for writing.");
+  auto it = metaIndex.find(path.c_str());
+  if (it == metaIndex.end()) {
+    sdCache.flush(path);
+    File file = SD_MMC.open(path);
+    if (!file || file.isDirectory()) {
+      Serial.println("Invalid file for metadata.");
+      return;
+    }
+    size_t fileSizeBytes = file.size();
+    file.close();
+    writeMetadata(path, fileSizeBytes, countVisibleChars(readFileToString(SD_MMC, path.c_str())));
     return;
   }
-  metaFile.print(updatedMeta);
-  metaFile.close();
 
-  Serial.println("Metadata updated.");
+  MetaEntry e = it->second;
+  e.stamp  = metaTimestamp();
+  e.bytes += bytesAdded;
+  e.chars += charsAdded;
+  putMetadata(path, e);
 }
 
 void loadFile(bool showOLED) {
@@ -113,24 +214,33 @@ void loadFile(bool showOLED) {
     return;
   }
   else {
-    SDActive = true;
-    setCpuFrequencyMhz(240);
-    delay(50);
+    IoBoostSession ioBoost;
 
     keypad.disableInterrupts();
     if (showOLED) oledWord("Loading File");
     if (!editingFile.startsWith("/")) editingFile = "/" + editingFile;
-    String textToLoad = readFileToString(SD_MMC, (editingFile).c_str());
-    if (DEBUG_VERBOSE) {
-      Serial.println("Text to load:");
-      Serial.println(textToLoad);
+
+    // LARGE FILES OPEN IN THE READ-ONLY VIEWER INSTEAD OF BEING LOADED WHOLE
+    txtView.close();
+    File file = SD_MMC.open(editingFile);
+    bool large = file && !file.isDirectory() && file.size() > TXT_VIEW_THRESHOLD;
+    if (file) file.close();
+
+    if (large && CurrentAppState != JOURNAL && txtView.open(editingFile)) {
+      stringToVector("");
+      setTXTFont(currentFont);
+      txtView.scroll(0, maxLines);
+    }
+    else {
+      String textToLoad = readFileToString(SD_MMC, (editingFile).c_str());
+      if (DEBUG_VERBOSE) {
+        Serial.println("Text to load:");
+        Serial.println(textToLoad);
+      }
+      stringToVector(textToLoad);
     }
-    stringToVector(textToLoad);
     keypad.enableInterrupts();
     if (showOLED) oledWord("File Loaded");
-    delay(200);
-    if (SAVE_POWER) setCpuFrequencyMhz(POWER_SAVE_FREQ);
-    SDActive = false;
   }
 }
 
@@ -141,9 +251,7 @@ void delFile(String fileName) {
     return;
   }
   else {
-    SDActive = true;
-    setCpuFrequencyMhz(240);
-    delay(50);
+    IoBoostSession ioBoost;
 
     keypad.disableInterrupts();
     oledWord("Deleting File: "+ fileName);
@@ -153,51 +261,21 @@ void delFile(String fileName) {
 
     // Delete MetaData
     deleteMetadata(fileName);
+    journalMarkEntry(fileName, false);
 
-    delay(1000);
     keypad.enableInterrupts();
-    if (SAVE_POWER) setCpuFrequencyMhz(POWER_SAVE_FREQ);
-    SDActive = false;
   }
 }
 
 void deleteMetadata(String path) {
-  const char* metaPath = SYS_METADATA_FILE;
-  
-
-  // Open metadata file for reading
-  File metaFile = SD_MMC.open(metaPath, FILE_READ);
-  if (!metaFile) {
-    Serial.println("Metadata file not found.");
-    return;
-  }
-
-  // Store lines that don't match the given path
-  std::vector<String> keptLines;
-  while (metaFile.available()) {
-    String line = metaFile.readStringUntil('\n');
-    if (!line.startsWith(path + "|")) {
-      keptLines.push_back(line);
-    }
-  }
-  metaFile.close();
-
-  // Delete the original metadata file
-  SD_MMC.remove(metaPath);
-
-  // Recreate the file and write back the kept lines
-  File writeFile = SD_MMC.open(metaPath, FILE_WRITE);
-  if (!writeFile) {
-    Serial.println("Failed to recreate metadata file.");
-    return;
-  }
+  loadMetadataIndex();
 
-  for (const String& line : keptLines) {
-    writeFile.println(line);
-  }
+  if (metaIndex.erase(path.c_str()) == 0) return;
+  appendMetaLine(path + "|-");
+  metaDeadRecords += 2;  // the old record and the tombstone itself
 
-  writeFile.close();
-  Serial.println("Metadata entry deleted (if it existed).");
+  if (metaDeadRecords > metaIndex.size() + META_COMPACT_SLACK) compactMetadata();
+  Serial.println("Metadata entry deleted.");
 }
 
 void renFile(String oldFile, String newFile) {
@@ -207,9 +285,7 @@ void renFile(String oldFile, String newFile) {
     return;
   }
   else {
-    SDActive = true;
-    setCpuFrequencyMhz(240);
-    delay(50);
+    IoBoostSession ioBoost;
 
     keypad.disableInterrupts();
     oledWord("Renaming "+ oldFile + " to " + newFile);
@@ -217,66 +293,105 @@ void renFile(String oldFile, String newFile) {
     if (!newFile.startsWith("/")) newFile = "/" + newFile;
     renameFile(SD_MMC, oldFile.c_str(), newFile.c_str());
     oledWord(oldFile + " -> " + newFile);
-    delay(1000);
 
     // Update MetaData
     renMetadata(oldFile, newFile);
+    journalMarkEntry(oldFile, false);
+    journalMarkEntry(newFile, true);
 
     keypad.enableInterrupts();
-    if (SAVE_POWER) setCpuFrequencyMhz(POWER_SAVE_FREQ);
-    SDActive = false;
   }
 }
 
 void renMetadata(String oldPath, String newPath) {
-  setCpuFrequencyMhz(240);
-  const char* metaPath = SYS_METADATA_FILE;
+  loadMetadataIndex();
 
-  // Open metadata file for reading
-  File metaFile = SD_MMC.open(metaPath, FILE_READ);
-  if (!metaFile) {
-    Serial.println("Metadata file not found.");
-    return;
-  }
+  auto it = metaIndex.find(oldPath.c_str());
+  if (it == metaIndex.end()) return;
 
-  std::vector<String> updatedLines;
-
-  while (metaFile.available()) {
-    String line = metaFile.readStringUntil('\n');
-    if (line.startsWith(oldPath + "|")) {
-      // Replace old path with new path at the start of the line
-      int separatorIndex = line.indexOf('|');
-      if (separatorIndex != -1) {
-        // Keep rest of line after '|'
-        String rest = line.substring(separatorIndex);
-        line = newPath + rest;
-      } else {
-        // Just replace whole line with new path if malformed
-        line = newPath;
-      }
-    }
-    updatedLines.push_back(line);
-  }
+  MetaEntry e = it->second;
+  deleteMetadata(oldPath);
+  putMetadata(newPath, e);
+  Serial.println("Metadata updated for renamed file.");
+}
 
-  metaFile.close();
+// FILE COPY
+static uint32_t fileCrc(File& file, uint8_t* buf) {
+  uint32_t crc = 0;
+  file.seek(0);
+  size_t n;
+  while ((n = file.read(buf, FILE_COPY_CHUNK)) > 0) crc = esp_rom_crc32_le(crc, buf, n);
+  return crc;
+}
 
-  // Delete old metadata file
-  SD_MMC.remove(metaPath);
+// Copies through one FILE_COPY_CHUNK buffer, so memory use doesn't grow with
+// the file. The CRC of what was read is checked against the written copy.
+static bool streamCopy(const String& from, const String& to, size_t& bytes, int& chars) {
+  if (from == to) return false;
+  noTimeout = true;
+  sdCache.flush(from);
+  sdCache.discard(to);
+
+  File src = SD_MMC.open(from, FILE_READ);
+  if (!src || src.isDirectory()) {
+    Serial.println("- failed to open file for copying");
+    noTimeout = false;
+    return false;
+  }
+  File dst = SD_MMC.open(to, FILE_WRITE);
+  if (!dst) {
+    Serial.println("- failed to open copy for writing");
+    src.close();
+    noTimeout = false;
+    return false;
+  }
+
+  std::unique_ptr<uint8_t[]> buf(new uint8_t[FILE_COPY_CHUNK]);
+  size_t total = src.size();
+  uint32_t crc = 0;
+  int shownPct = -1;
+  bool ok = true;
+  bytes = 0;
+  chars = 0;
+
+  size_t n;
+  while ((n = src.read(buf.get(), FILE_COPY_CHUNK)) > 0) {
+    crc = esp_rom_crc32_le(crc, buf.get(), n);
+    for (size_t i = 0; i < n; i++) {
+      if (buf[i] >= 32 && buf[i] <= 126) chars++;
+    }
+    if (dst.write(buf.get(), n) != n) {
+      ok = false;
+      break;
+    }
+    bytes += n;
 
-  // Recreate file and write updated lines
-  File writeFile = SD_MMC.open(metaPath, FILE_WRITE);
-  if (!writeFile) {
-    Serial.println("Failed to recreate metadata file.");
-    return;
+    int pct = total ? (int)((uint64_t)bytes * 100 / total) : 100;
+    if (pct / 5 != shownPct / 5) {
+      shownPct = pct;
+      oledLine("Copying " + String(pct) + "%", false, to);
+    }
   }
+  src.close();
+  dst.close();
 
-  for (const String& l : updatedLines) {
-    writeFile.println(l);
+  // Read the copy back and compare
+  if (ok) {
+    File check = SD_MMC.open(to, FILE_READ);
+    ok = check && check.size() == bytes && fileCrc(check, buf.get()) == crc;
+    if (check) check.close();
+  }
+  if (!ok) {
+    Serial.println("- copy failed verification");
+    SD_MMC.remove(to);
+  }
+  else {
+    Serial.println("- file copied");
   }
 
-  writeFile.close();
-  Serial.println("Metadata updated for renamed file.");
-  if (SAVE_POWER) setCpuFrequencyMhz(40);
+  sdIndex.update(to);
+  noTimeout = false;
+  return ok;
 }
 
 void copyFile(String oldFile, String newFile) {
@@ -286,26 +401,25 @@ void copyFile(String oldFile, String newFile) {
     return;
   }
   else {
-    SDActive = true;
-    setCpuFrequencyMhz(240);
-    delay(50);
+    IoBoostSession ioBoost;
 
     keypad.disableInterrupts();
-    oledWord("Loading File");
     if (!oldFile.startsWith("/")) oldFile = "/" + oldFile;
     if (!newFile.startsWith("/")) newFile = "/" + newFile;
-    String textToLoad = readFileToString(SD_MMC, (oldFile).c_str());
-    writeFile(SD_MMC, (newFile).c_str(), textToLoad.c_str());
-    oledWord("Saved: "+ newFile);
 
-    // Write MetaData
-    writeMetadata(newFile);
+    size_t bytes = 0;
+    int    chars = 0;
+    if (streamCopy(oldFile, newFile, bytes, chars)) {
+      oledWord("Saved: "+ newFile);
+      // Write MetaData
+      writeMetadata(newFile, bytes, chars);
+      journalMarkEntry(newFile, true);
+    }
+    else {
+      oledWord("COPY FAILED: "+ newFile);
+    }
 
-    delay(1000);
     keypad.enableInterrupts();
-
-    if (SAVE_POWER) setCpuFrequencyMhz(POWER_SAVE_FREQ);
-    SDActive = false;
   }
 }
 
@@ -316,33 +430,27 @@ void appendToFile(String path, String inText) {
     return;
   }
   else {
-    SDActive = true;
-    setCpuFrequencyMhz(240);
-    delay(50);
+    IoBoostSession ioBoost;
 
     keypad.disableInterrupts();
     appendFile(SD_MMC, path.c_str(), inText.c_str());
 
-    // Write MetaData
-    writeMetadata(path);
+    // Write MetaData (appendFile adds a CRLF)
+    appendMetadata(path, inText.length() + 2, countVisibleChars(inText));
 
     keypad.enableInterrupts();
-
-    if (SAVE_POWER) setCpuFrequencyMhz(POWER_SAVE_FREQ);
-    SDActive = false;
   }
 }
 
 String vectorToString() {
   String result;
   setTXTFont(currentFont);
+  const GlyphAdvance& adv = glyphAdvance(currentFont);
 
   for (size_t i = 0; i < allLines.size(); i++) {
     result += allLines[i];
 
-    int16_t x1, y1;
-    uint16_t charWidth, charHeight;
-    display.getTextBounds(allLines[i], 0, 0, &x1, &y1, &charWidth, &charHeight);
+    uint16_t charWidth = adv.measure(allLines[i]);
 
     // Add newline only if the line doesn't fully use the available space
     if (charWidth < display.width() && i < allLines.size() - 1) {
@@ -354,49 +462,10 @@ String vectorToString() {
 }
 
 void stringToVector(String inputText) {
-  setTXTFont(currentFont);
-  allLines.clear();
-  String currentLine_;
-
-  for (size_t i = 0; i < inputText.length(); i++) {
-    char c = inputText[i];
-
-    int16_t x1, y1;
-    uint16_t charWidth, charHeight;
-    display.getTextBounds(currentLine_, 0, 0, &x1, &y1, &charWidth, &charHeight);
-
-    // Check if new line needed
-    if ((c == '\n' || charWidth >= display.width() - 5) && !currentLine_.isEmpty()) {
-      if (currentLine_.endsWith(" ")) {
-        allLines.push_back(currentLine_);
-        currentLine_ = "";
-      }
-      else {
-        int lastSpace = currentLine_.lastIndexOf(' ');
-        if (lastSpace != -1) {
-          // Split line at last space
-          String partialWord = currentLine_.substring(lastSpace + 1);
-          currentLine_ = currentLine_.substring(0, lastSpace);
-          allLines.push_back(currentLine_);
-          currentLine_ = partialWord;  // Start new line with partial word
-        }
-        else {
-          // No spaces, whole line is a single word
-          allLines.push_back(currentLine_);
-          currentLine_ = "";
-        }
-      }
-    }
-    
-    if (c != '\n') {
-      currentLine_ += c;
-    }
-  }
-
-  // Push last line if not empty
-  if (!currentLine_.isEmpty()) {
-    allLines.push_back(currentLine_);
-  }
+  // Load the text as the TXT document and wrap it into allLines
+  txtDoc.load(inputText);
+  txtCursor = txtDoc.length();
+  txtLayout();
 }
 
 String removeChar(String str, char character) {
@@ -453,22 +522,21 @@ void updateBattState() {
 }
 
 void TCA8418_irq() {
-  TCA8418_event = true;
+  keyQueue.isr();
 }
 
 void PWR_BTN_irq() {
   PWR_BTN_event = true;
 }
 
+void MPR121_irq() {
+  MPR121_event = true;
+}
+
 char updateKeypress() {
-  if (TCA8418_event == true) {
-    int k = keypad.getEvent();
-    
-    //  try to clear the IRQ flag
-    //  if there are pending events it is not cleared
-    keypad.writeRegister(TCA8418_REG_INT_STAT, 1);
-    int intstat = keypad.readRegister(TCA8418_REG_INT_STAT);
-    if ((intstat & 0x01) == 0) TCA8418_event = false;
+  uint8_t code;
+  while (keyQueue.pop(code)) {
+    int k = code;
 
     if (k & 0x80) {   //Key pressed, not released
       k &= 0x7F;
@@ -511,8 +579,8 @@ void setTimeFromString(String timeStr) {
       return;
     }
 
-    DateTime now = rtc.now();  // Get current date
-    rtc.adjust(DateTime(now.year(), now.month(), now.day(), hours, minutes, 0));
+    DateTime now = timeService.now();  // Get current date
+    timeService.set(DateTime(now.year(), now.month(), now.day(), hours, minutes, 0));
 
     Serial.println("Time updated!");
 }
@@ -636,11 +704,12 @@ void checkTimeout() {
         int j = millis();
         while ((j - i) <= 4000) {  //10 sec
           j = millis();
-          if (digitalRead(KB_IRQ) == 0) {
+          if (digitalRead(KB_IRQ) == 0 || keyQueue.pending()) {
             oledWord("Good Save!");
             delay(500);
             prevTimeMillis = millis();
             keypad.flush();
+            keyQueue.clear();
             return;
           }
         }
@@ -717,7 +786,6 @@ void checkTimeout() {
       CurrentAppState = HOME;
       CurrentHOMEState = NOWLATER;
       updateTaskArray();
-      sortTasksByDueDate(tasks);
 
       u8g2.setPowerSave(1);
       OLEDPowerSave  = true;
@@ -774,6 +842,8 @@ void checkTimeout() {
     prefs.end();*/
     loadState();
     keypad.flush();
+    keyQueue.clear();
+    timeService.sync();
 
     CurrentHOMEState = HOME_HOME;
     PWR_BTN_event = false;
@@ -794,6 +864,10 @@ void checkTimeout() {
 }
 
 void deepSleep(bool alternateScreenSaver) {
+  // Finish background saves and write out queued appends before power goes
+  ioWorker.drain();
+  sdCache.flushAll();
+
   // Put OLED to sleep
   u8g2.setPowerSave(1);
 
@@ -860,6 +934,7 @@ void loadState(bool changeState) {
     else CurrentAppState = static_cast<AppState>(prefs.getInt("CurrentAppState", HOME));
     
     keypad.flush();
+    keyQueue.clear();
 
     // Initialize boot app if needed
     switch (CurrentAppState) {
@@ -908,62 +983,53 @@ void loadState(bool changeState) {
 }
 
 // Low-Level SDMMC Operations
-void listDir(fs::FS &fs, const char *dirname) {
+void listDir() {
   if (noSD) {
     oledWord("OP FAILED - No SD!");
     delay(5000);
     return;
   }
   else {
-    setCpuFrequencyMhz(240);
-    delay(50);
-    noTimeout = true;
-    Serial.printf("Listing directory: %s\r\n", dirname);
-
-    File root = fs.open(dirname);
-    if (!root) {
-      Serial.println("- failed to open directory");
-      return;
-    }
-    if (!root.isDirectory()) {
-      Serial.println(" - not a directory");
-      return;
-    }
-
-    // Reset fileIndex and initialize filesList with "-"
-    fileIndex = 0; // Reset fileIndex
-    for (int i = 0; i < MAX_FILES; i++) {
-      filesList[i] = "-";
-    }
+    // filesList shows page filesPage of the cached directory index, the card
+    // is only walked the first time or after sdIndex.invalidate()
+    SdBusLock bus;
+    size_t pages = sdIndex.pageCount(MAX_FILES);
+    filesPageCount = pages;  // for the pickers' page counter, read outside the lock
+    if (filesPage >= pages) filesPage = pages - 1;
+    sdIndex.fillPage(filesPage, filesList, MAX_FILES);
 
-    File file = root.openNextFile();
-    while (file && fileIndex < MAX_FILES) {
-      if (!file.isDirectory()) {
-        String fileName = String(file.name());
-        
-        // Check if file is in the exclusion list
-        bool excluded = false;
-        for (const String &excludedFile : excludedFiles) {
-          if (fileName.equals(excludedFile) || ("/"+fileName).equals(excludedFile)) {
-            excluded = true;
-            break;
-          }
-        }
+    fileIndex = 0;
+    while (fileIndex < MAX_FILES && filesList[fileIndex] != "-") fileIndex++;
+  }
+}
 
-        if (!excluded) {
-          filesList[fileIndex++] = fileName; // Store file name if not excluded
-        }
-      }
-      file = root.openNextFile();
-    }
+// Build the directory index in the background so the first picker opens instantly
+void prefetchDirIndex() {
+  if (noSD) return;
+  ioWorker.submit([]() {
+    IoBoostSession ioBoost;
+    sdIndex.warm();
+    return true;
+  });
+}
 
-    for (int i = 0; i < fileIndex; i++) { // Only print valid entries
-      Serial.println(filesList[i]);
-    }
+void filesPageStep(int delta) {
+  SdBusLock bus;
+  long page = (long)filesPage + delta;
+  long pages = sdIndex.pageCount(MAX_FILES);
+  if (page < 0 || page >= pages) return;
+  filesPage = page;
+  oledWord("Page " + String((int)page + 1) + "/" + String((int)pages));
+}
 
-    noTimeout = false;
-    //if (SAVE_POWER) setCpuFrequencyMhz(40);
-  }
+void filesCycleSort() {
+  SdBusLock bus;
+  DirSort next = (DirSort)((sdIndex.sortKey() + 1) % 3);
+  sdIndex.setSort(next);
+  filesPage = 0;
+  if (next == SORT_NAME)      oledWord("Sort: Name");
+  else if (next == SORT_DATE) oledWord("Sort: Newest");
+  else                        oledWord("Sort: Largest");
 }
 
 void readFile(fs::FS &fs, const char *path) {
@@ -973,8 +1039,7 @@ void readFile(fs::FS &fs, const char *path) {
     return;
   }
   else {
-    setCpuFrequencyMhz(240);
-    delay(50);
+    IoBoostSession ioBoost;
     noTimeout = true;
     Serial.printf("Reading file: %s\r\n", path);
 
@@ -990,7 +1055,6 @@ void readFile(fs::FS &fs, const char *path) {
     }
     file.close();
     noTimeout = false;
-    //if (SAVE_POWER) setCpuFrequencyMhz(40);
   }
 }
 
@@ -1001,11 +1065,11 @@ String readFileToString(fs::FS &fs, const char *path) {
     return "";
   }
   else { 
-    setCpuFrequencyMhz(240);
-    delay(50);
+    IoBoostSession ioBoost;
 
     noTimeout = true;
     Serial.printf("Reading file: %s\r\n", path);
+    if (&fs == &SD_MMC) sdCache.flush(path);
 
     File file = fs.open(path);
     if (!file || file.isDirectory()) {
@@ -1016,10 +1080,15 @@ String readFileToString(fs::FS &fs, const char *path) {
     }
 
     Serial.println("- reading from file:");
-    String content = "";  // Initialize an empty String to hold the content
+    String content = "";
+    content.reserve(file.size());
 
+    // Read in blocks straight into the reserved String
+    char buf[FILE_IO_CHUNK];
     while (file.available()) {
-      content += (char)file.read();  // Read each character and append to the String
+      size_t n = file.read((uint8_t*)buf, sizeof(buf));
+      if (n == 0) break;
+      content.concat(buf, n);
     }
 
     file.close();
@@ -1029,33 +1098,43 @@ String readFileToString(fs::FS &fs, const char *path) {
   }
 }
 
-void writeFile(fs::FS &fs, const char *path, const char *message) {
+bool writeFile(fs::FS &fs, const char *path, const char *message) {
   if (noSD) {
     oledWord("OP FAILED - No SD!");
     delay(5000);
-    return;
+    return false;
   }
   else {
-    setCpuFrequencyMhz(240);
-    delay(50);
+    IoBoostSession ioBoost;
     noTimeout = true;
     Serial.printf("Writing file: %s\r\n", path);
-    delay(200);
+    if (&fs == &SD_MMC) sdCache.discard(path);
 
     File file = fs.open(path, FILE_WRITE);
     if (!file) {
       Serial.println("- failed to open file for writing");
-      return;
+      noTimeout = false;
+      return false;
+    }
+
+    // Write in FILE_IO_CHUNK blocks
+    size_t len = strlen(message);
+    size_t written = 0;
+    while (written < len) {
+      size_t n = file.write((const uint8_t*)message + written, std::min<size_t>(len - written, FILE_IO_CHUNK));
+      if (n == 0) break;
+      written += n;
     }
-    if (file.print(message)) {
+    if (written == len) {
       Serial.println("- file written");
     } 
     else {
       Serial.println("- write failed");
     }
     file.close();
+    sdIndex.update(path);
     noTimeout = false;
-    //if (SAVE_POWER) setCpuFrequencyMhz(40);
+    return written == len;
   }
 }
 
@@ -1066,11 +1145,17 @@ void appendFile(fs::FS &fs, const char *path, const char *message) {
     return;
   }
   else {
-    setCpuFrequencyMhz(240);
-    delay(50);
+    IoBoostSession ioBoost;
     noTimeout = true;
     Serial.printf("Appending to file: %s\r\n", path);
 
+    // Small appends are coalesced in sdCache, written out later in one go
+    if (&fs == &SD_MMC && sdCache.append(path, message, strlen(message))) {
+      sdCache.append(path, "\r\n", 2);
+      noTimeout = false;
+      return;
+    }
+
     File file = fs.open(path, FILE_APPEND);
     if (!file) {
       Serial.println("- failed to open file for appending");
@@ -1083,8 +1168,8 @@ void appendFile(fs::FS &fs, const char *path, const char *message) {
       Serial.println("- append failed");
     }
     file.close();
+    sdIndex.update(path);
     noTimeout = false;
-    //if (SAVE_POWER) setCpuFrequencyMhz(40);
   }
 }
 
@@ -1095,18 +1180,20 @@ void renameFile(fs::FS &fs, const char *path1, const char *path2) {
     return;
   }
   else {
-    setCpuFrequencyMhz(240);
-    delay(50);
+    IoBoostSession ioBoost;
     noTimeout = true;
     Serial.printf("Renaming file %s to %s\r\n", path1, path2);
+    // path1 may be a directory with queued appends to its children
+    if (&fs == &SD_MMC) sdCache.flushAll();
     if (fs.rename(path1, path2)) {
       Serial.println("- file renamed");
     } 
     else {
       Serial.println("- rename failed");
     }
+    sdIndex.update(path1);
+    sdIndex.update(path2);
     noTimeout = false;
-    //if (SAVE_POWER) setCpuFrequencyMhz(40);
   }
 }
 
@@ -1117,18 +1204,18 @@ void deleteFile(fs::FS &fs, const char *path) {
     return;
   }
   else {
-    setCpuFrequencyMhz(240);
-    delay(50);
+    IoBoostSession ioBoost;
     noTimeout = true;
     Serial.printf("Deleting file: %s\r\n", path);
+    if (&fs == &SD_MMC) sdCache.discard(path);
     if (fs.remove(path)) {
       Serial.println("- file deleted");
     } 
     else {
       Serial.println("- delete failed");
     }
+    sdIndex.update(path);
     noTimeout = false;
-    //if (SAVE_POWER) setCpuFrequencyMhz(40);
   }
 }
 
@@ -1166,12 +1253,54 @@ static KeyMapping parseCellToken(const String& tok) {
   return km;
 }
 
+// Action names used by the object-form cells: {"action": "CHAR", "text": "a"}
+static const struct { const char* name; KeyAction action; } ACTION_NAMES[] = {
+  {"CHAR", KA_CHAR},          {"DEAD", KA_DEAD},           {"BACKSPACE", KA_BACKSPACE},
+  {"TAB", KA_TAB},            {"ENTER", KA_ENTER},         {"SHIFT", KA_SHIFT},
+  {"FN", KA_FN},              {"LEFT", KA_LEFT},           {"RIGHT", KA_RIGHT},
+  {"UP", KA_UP},              {"DOWN", KA_DOWN},           {"SELECT", KA_SELECT},
+  {"HOME", KA_HOME},          {"DELETE", KA_DELETE},       {"SPACE", KA_SPACE},
+  {"CLEAR", KA_CLEAR},        {"FONT", KA_FONT},           {"SAVE", KA_SAVE},
+  {"LOAD", KA_LOAD},          {"FILE", KA_FILE},           {"ESC", KA_ESC},
+  {"CYCLE_LAYOUT", KA_CYCLE_LAYOUT},
+};
+
+static KeyMapping parseCellObject(const String& name, const String& text) {
+  KeyMapping km{KA_NONE, text};
+  // DEAD_ACUTE etc. carry their accent as text, so they compose like DEAD
+  if (name.startsWith("DEAD")) {
+    km.action = KA_DEAD;
+    return km;
+  }
+  for (const auto& a : ACTION_NAMES) {
+    if (name == a.name) {
+      km.action = a.action;
+      break;
+    }
+  }
+  return km;
+}
+
 // Layout loader (reads /sys/kbd/<name>.json)
+// The JSON is only parsed when its compiled <name>.kbl is missing or older
+// than the JSON; otherwise switching layouts is one read of the .kbl.
 bool loadKeyboardLayoutFromFile(const char* path) {
   if (noSD) return false;
+  SdBusLock bus;
   File f = SD_MMC.open(path, "r");
   if (!f) return false;
 
+  uint32_t srcSize  = f.size();
+  uint32_t srcMtime = (uint32_t)f.getLastWrite();
+  String compiled = String(path);
+  compiled = compiled.substring(0, compiled.lastIndexOf('.')) + ".kbl";
+
+  if (ActiveLayout.loadFile(compiled.c_str(), srcSize, srcMtime)) {
+    f.close();
+    applyLayoutToLegacyArrays();
+    return true;
+  }
+
   // generous pool; adjust if needed
   DynamicJsonDocument doc(32 * 1024);
   DeserializationError err = deserializeJson(doc, f);
@@ -1181,13 +1310,18 @@ bool loadKeyboardLayoutFromFile(const char* path) {
   KeyboardLayout L;
   L.name = doc["name"] | "custom";
 
+  // Layers are either top-level arrays of action objects or "layers"
+  // arrays of string tokens
   auto loadLayer = [&](const char* key, KeyMapping dest[4][10]) {
-    if (!doc["layers"].containsKey(key)) return false;
-    JsonArray layer = doc["layers"][key];
+    JsonArray layer = doc[key];
+    if (layer.isNull()) layer = doc["layers"][key];
+    if (layer.isNull()) return false;
     for (int r=0; r<4; ++r) {
       JsonArray row = layer[r];
       for (int c=0; c<10; ++c) {
-        dest[r][c] = parseCellToken(String(row[c].as<const char*>())); 
+        JsonVariant cell = row[c];
+        if (cell.is<JsonObject>()) dest[r][c] = parseCellObject(String(cell["action"] | ""), String(cell["text"] | ""));
+        else                       dest[r][c] = parseCellToken(String(cell.as<const char*>()));
       }
     }
     return true;
@@ -1198,24 +1332,34 @@ bool loadKeyboardLayoutFromFile(const char* path) {
   if (!loadLayer("fn",     L.fn))     return false;
 
   // Dead-key table
-  DeadTable.clear();
-  if (doc["layers"].containsKey("dead")) {
-    JsonObject dead = doc["layers"]["dead"];
-    for (JsonPair kv1 : dead) {
-      String accent = String(kv1.key().c_str());
-      JsonObject bases = kv1.value().as<JsonObject>();
-      for (JsonPair kv2 : bases) {
-        DeadRule rule{accent, String(kv2.key().c_str()), String(kv2.value().as<const char*>())};
-        DeadTable.push_back(rule);
-      }
+  JsonObject dead = doc["dead_keys"];
+  if (dead.isNull()) dead = doc["layers"]["dead"];
+  for (JsonPair kv1 : dead) {
+    String accent = String(kv1.key().c_str());
+    JsonObject bases = kv1.value().as<JsonObject>();
+    for (JsonPair kv2 : bases) {
+      L.deadKeys[accent][String(kv2.key().c_str())] = String(kv2.value().as<const char*>());
     }
   }
 
+  std::vector<uint8_t> blob = compileKeyboardLayout(L, srcSize, srcMtime);
+  File out = SD_MMC.open(compiled.c_str(), FILE_WRITE);
+  if (out) {
+    if (out.write(blob.data(), blob.size()) != blob.size()) Serial.println("Failed to cache " + compiled);
+    out.close();
+  }
+  if (!ActiveLayout.adopt(blob)) return false;
+
   CurrentLayout = L;
   applyLayoutToLegacyArrays();
   return true;
 }
 
+bool loadKeyboardLayout(const String& layoutName) {
+  if (layoutName.startsWith("/")) return loadKeyboardLayoutFromFile(layoutName.c_str());
+  return loadKeyboardLayoutFromFile(("/sys/kbd/" + layoutName + ".json").c_str());
+}
+
 bool selectKeyboardLayout(const String& name) {
   String p = "/sys/kbd/" + name + ".json";
   if (loadKeyboardLayoutFromFile(p.c_str())) {
@@ -1284,21 +1428,6 @@ void utf8_pop_back_inplace(String& s) {
   s.remove(i);
 }
 
-// Dead-key composition (data-driven)
-String composeDeadIfAny(const String& base) {
-  if (CurrentDead.length() == 0) return base;
-  for (const auto& r : DeadTable) {
-    if (r.accent == CurrentDead && r.base == base) {
-      CurrentDead = "";
-      return r.out;
-    }
-  }
-  // fallback: emit accent + base
-  String out = CurrentDead + base;
-  CurrentDead = "";
-  return out;
-}
-
 // UTF-8 key reader (parallel to legacy updateKeypress())
 KeyEvent updateKeypressUTF8() {
   KeyEvent ev{false, KA_NONE, "", 0, 0};
@@ -1312,12 +1441,11 @@ KeyEvent updateKeypressUTF8() {
   }
 #endif
 
-  if (TCA8418_event == true) {
-    int k = keypad.getEvent();
-    // clear IRQ if no pending events
-    keypad.writeRegister(TCA8418_REG_INT_STAT, 1);
-    int intstat = keypad.readRegister(TCA8418_REG_INT_STAT);
-    if ((intstat & 0x01) == 0) TCA8418_event = false;
+  // Modifier toggles and releases produce nothing, so read on past them to
+  // the next key a batch can use
+  uint8_t code;
+  while (keyQueue.pop(code)) {
+    int k = code;
 
     if (k & 0x80) { // pressed, not released
       k &= 0x7F;
@@ -1326,26 +1454,21 @@ KeyEvent updateKeypressUTF8() {
         ev.row = k/10;
         ev.col = k%10;
 
-        KeyMapping km;
-        switch (CurrentKBState) {
-          case NORMAL: km = CurrentLayout.normal[ev.row][ev.col]; break;
-          case SHIFT:  km = CurrentLayout.shift_[ev.row][ev.col]; break;
-          case FUNC:   km = CurrentLayout.fn[ev.row][ev.col];     break;
-        }
+        KeyAction action = (KeyAction)ActiveLayout.action(CurrentKBState, ev.row, ev.col);
 
         // Toggling is handled here to emulate legacy behavior
-        if (km.action == KA_SHIFT) {
+        if (action == KA_SHIFT) {
           CurrentKBState = (CurrentKBState == SHIFT) ? NORMAL : SHIFT;
-          return ev; // no text produced
+          continue; // no text produced
         }
-        if (km.action == KA_FN) {
+        if (action == KA_FN) {
           CurrentKBState = (CurrentKBState == FUNC) ? NORMAL : FUNC;
-          return ev;
+          continue;
         }
 
         ev.hasEvent = true;
-        ev.action = km.action;
-        ev.text = km.text;
+        ev.action = action;
+        ev.text = ActiveLayout.text(CurrentKBState, ev.row, ev.col);
         return ev;
       }
     }
@@ -42,6 +42,11 @@ echo "[INFO] Building project..."
 make -j$(sysctl -n hw.ncpu)
 
 echo "[SUCCESS] Build completed successfully!"
+
+# Run the headless checks
+echo "[INFO] Running tests..."
+ctest --output-on-failure
+
 echo "[INFO] Executable: $(pwd)/PocketMage_Desktop_Emulator"
 echo "[SUCCESS] Assets copied to build directory"
 
@@ -31,11 +31,13 @@ public:
     size_t write(const uint8_t* data, size_t len);
     size_t write(const String& str);
     int read();
+    size_t read(uint8_t* buf, size_t len);
     String readString();
     String readStringUntil(char terminator);
     bool available();
     void seek(size_t pos);
     size_t size();
+    time_t getLastWrite();
     String name();
     bool isDirectory();
     File openNextFile();
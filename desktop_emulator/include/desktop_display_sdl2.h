@@ -26,6 +26,7 @@ public:
     void cleanup();
     
     void einkClear();
+    void einkFill(bool black);
     void einkSetPixel(int x, int y, bool black);
     void einkDrawText(const std::string& text, int x, int y, int size, bool whiteText=false);
     void einkDrawLine(int x0, int y0, int x1, int y1, bool black=true);
@@ -0,0 +1,28 @@
+#pragma once
+#include "MscCache.h"
+#include <fstream>
+#include <string>
+
+// Disk image standing in for the SD card behind USB mass storage, so the
+// MscCache transfer path can be exercised on the desktop. Counts the
+// transfers that reach the "card" to show what the cache saves.
+class FileBlockDevice : public BlockDevice {
+public:
+    FileBlockDevice(const std::string& path, uint32_t sectors, uint32_t sectorSize = 512);
+
+    bool isOpen() const { return file_.is_open(); }
+
+    uint32_t sectorSize() override { return sectorSize_; }
+    uint32_t sectorCount() override { return sectors_; }
+    bool readSectors(uint8_t* dst, uint32_t lba, uint32_t count) override;
+    bool writeSectors(const uint8_t* src, uint32_t lba, uint32_t count) override;
+
+    uint32_t readCommands = 0;
+    uint32_t writeCommands = 0;
+    bool     failWrites = false;   // simulate a card error
+
+private:
+    std::fstream file_;
+    uint32_t sectors_;
+    uint32_t sectorSize_;
+};
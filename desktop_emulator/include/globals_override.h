@@ -17,6 +17,6 @@ extern sdmmc_card_t* card;
 
 // Function overrides
 void drawStatusBar(String input);
-void oledLine(String line, bool doProgressBar = true, String bottomMsg = "");
+void oledLine(String line, bool doProgressBar = true, String bottomMsg = "", int cursorPos = -1);
 
 #endif
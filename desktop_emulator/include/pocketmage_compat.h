@@ -48,6 +48,8 @@ public:
     String& operator+=(const String& other) { data += other.data; return *this; }
     String& operator+=(const char* str) { if(str) data += str; return *this; }
     String& operator+=(char c) { data += c; return *this; }
+    bool reserve(size_t size) { data.reserve(size); return true; }
+    bool concat(const char* str, size_t len) { if (str) data.append(str, len); return true; }
     
     bool operator==(const String& other) const { return data == other.data; }
     bool operator!=(const String& other) const { return data != other.data; }
@@ -203,6 +205,7 @@ public:
     DateTime(const char* date, const char* time) {} // Constructor for F(__DATE__), F(__TIME__)
     DateTime(int year, int month, int day) {}
     DateTime(int year, int month, int day, int hour, int minute, int second) {}
+    explicit DateTime(uint32_t t) : unix_(t) {}
     int year() const { return 2025; }
     int month() const { return 8; }
     int day() const { return 17; }
@@ -215,6 +218,9 @@ public:
     DateTime operator+(const TimeSpan& ts) const;
     TimeSpan operator-(const DateTime& other) const;
     String toString() const { return String("2025-08-17 08:14:00"); }
+    uint32_t unixtime() const { return unix_; }
+private:
+    uint32_t unix_ = 1755418440;  // 2025-08-17 08:14:00
 };
 
 // RTC mock
@@ -252,7 +258,7 @@ int analogRead(uint8_t pin);
 #endif
 
 // PocketMage specific functions that need to be mocked
-void listDir(SD_MMCClass& fs, const char* dirname);
+void listDir();
 void refresh();
 void drawThickLine(int x0, int y0, int x1, int y1, int thickness);
 String removeChar(String str, char c);
@@ -428,6 +434,8 @@ typedef struct {} sdmmc_card_t;
 typedef RTC_DS3231 RTC_PCF8563;
 
 // Display types for globals.h compatibility
+// Like the real GxEPD2 paged buffer, draw calls only touch the framebuffer and
+// mark it dirty; the window is presented once per display() call.
 class GxEPD2_310_GDEQ031T10 {
 public:
     static const int HEIGHT = 128;
@@ -452,17 +460,20 @@ public:
     }
     void fillScreen(uint16_t color) {
         if (g_display) {
-            g_display->einkClear(); // This already calls einkForceFullRefresh()
+            g_display->einkFill(color == GxEPD_BLACK);
+            dirty = true;
         }
     }
     void display(bool partial = false) {
-        if (g_display) {
-            if (partial) {
-                g_display->einkPartialRefresh();
-            } else {
-                g_display->einkForceFullRefresh(); // Force full refresh for complete clearing
-            }
+        if (!g_display) return;
+        if (partial) {
+            // Partial updates only upload changed rows, skip them when nothing was drawn
+            if (!dirty) return;
+            g_display->einkPartialRefresh();
+        } else {
+            g_display->einkForceFullRefresh();
         }
+        dirty = false;
     }
     void hibernate() {}
     void nextPage() {}
@@ -478,7 +489,7 @@ public:
             bool isWhiteText = (text_color == GxEPD_WHITE);
             g_display->einkDrawText(text, cursor_x, cursor_y, 12, isWhiteText);
             cursor_x += strlen(text) * 8;
-            g_display->present(); // Force immediate rendering
+            dirty = true;
         }
     }
     void print(const String& text) { print(text.c_str()); }
@@ -486,12 +497,14 @@ public:
         if (g_display) {
             bool black = (color == GxEPD_BLACK);
             g_display->einkDrawRect(x, y, w, h, false, black);
+            dirty = true;
         }
     }
     void fillRect(int x, int y, int w, int h, uint16_t color) {
         if (g_display) {
             bool black = (color == GxEPD_BLACK);
             g_display->einkDrawRect(x, y, w, h, true, black);
+            dirty = true;
         }
     }
     void drawBitmap(int x, int y, const uint8_t* bitmap, int w, int h, uint16_t color) {
@@ -499,19 +512,20 @@ public:
             std::cout << "[BITMAP] Drawing bitmap at (" << x << "," << y << ") size " << w << "x" << h 
                       << " color=" << (color == GxEPD_BLACK ? "BLACK" : "WHITE") << std::endl;
             g_display->einkDrawBitmap(x, y, (const unsigned char*)bitmap, w, h, color == GxEPD_BLACK);
+            dirty = true;
         }
     }
     void drawPixel(int x, int y, uint16_t color) {
-        if (g_display) g_display->einkSetPixel(x, y, color == GxEPD_BLACK);
+        if (g_display) { g_display->einkSetPixel(x, y, color == GxEPD_BLACK); dirty = true; }
     }
     void drawLine(int x0, int y0, int x1, int y1, uint16_t color) {
-        if (g_display) g_display->einkDrawLine(x0, y0, x1, y1);
+        if (g_display) { g_display->einkDrawLine(x0, y0, x1, y1); dirty = true; }
     }
     void drawCircle(int x, int y, int r, uint16_t color) {
-        if (g_display) g_display->einkDrawCircle(x, y, r, false);
+        if (g_display) { g_display->einkDrawCircle(x, y, r, false); dirty = true; }
     }
     void fillCircle(int x, int y, int r, uint16_t color) {
-        if (g_display) g_display->einkDrawCircle(x, y, r, true);
+        if (g_display) { g_display->einkDrawCircle(x, y, r, true); dirty = true; }
     }
     void getTextBounds(const char* text, int x, int y, int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h) {
         if (g_display && text) {
@@ -532,6 +546,7 @@ private:
     int cursor_x = 0;
     int cursor_y = 0;
     uint16_t text_color = GxEPD_BLACK;
+    bool dirty = false;
 };
 
 // Template compatibility for GxEPD2_BW
@@ -562,6 +577,8 @@ typedef U8G2_SH1106_128X32_VISIONOX_F_HW_I2C U8G2_SSD1326_ER_256X32_F_4W_HW_SPI;
 inline bool isDigit(char c) { return std::isdigit(c); }
 inline uint32_t getCpuFrequencyMhz() { return 240; }
 inline void esp_deep_sleep_start() { /* Mock deep sleep */ }
+inline bool psramFound() { return false; }
+inline void* ps_malloc(size_t size) { return malloc(size); }
 
 // Arduino compatibility functions (inline to avoid multiple definitions)
 inline long map(long x, long in_min, long in_max, long out_min, long out_max) {
@@ -240,24 +240,14 @@ void DesktopDisplay::cleanup() {
 
 // E-Ink display methods
 void DesktopDisplay::einkClear() {
-    DEBUG_LOG("EINK", "einkClear() called - aggressive clearing");
-    
-    // Step 1: Clear the buffer completely
-    std::fill(einkBuffer.begin(), einkBuffer.end(), 255);
-    
-    // Step 2: Reset previous buffer to force dirty detection
-    const size_t N = size_t(EINK_WIDTH) * size_t(EINK_HEIGHT);
-    einkPrevBuffer.assign(N, 0); // Set to black so white buffer is detected as changed
-    
-    // Step 3: Force immediate full refresh
-    DEBUG_LOG("EINK", "Calling einkForceFullRefresh() to clear screen");
+    DEBUG_LOG("EINK", "einkClear() called");
+    einkFill(false);
     einkForceFullRefresh();
-    
-    // Step 4: Additional safety clear - fill buffer again and refresh again
-    std::fill(einkBuffer.begin(), einkBuffer.end(), 255);
-    einkForceFullRefresh();
-    
-    DEBUG_LOG("EINK", "Aggressive screen clearing complete");
+}
+
+// Buffer-only fill, presented by the next refresh like the device framebuffer
+void DesktopDisplay::einkFill(bool black) {
+    std::fill(einkBuffer.begin(), einkBuffer.end(), black ? 0 : 255);
 }
 
 void DesktopDisplay::einkSetPixel(int x, int y, bool black) {
@@ -0,0 +1,36 @@
+#include "file_block_device.h"
+#include <filesystem>
+#include <iostream>
+
+FileBlockDevice::FileBlockDevice(const std::string& path, uint32_t sectors, uint32_t sectorSize)
+    : sectors_(sectors), sectorSize_(sectorSize) {
+    // Create a sparse image of the requested size on first use
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec)) {
+        std::ofstream create(path, std::ios::binary);
+    }
+    if (std::filesystem::file_size(path, ec) < (uintmax_t)sectors * sectorSize) {
+        std::filesystem::resize_file(path, (uintmax_t)sectors * sectorSize, ec);
+    }
+    file_.open(path, std::ios::in | std::ios::out | std::ios::binary);
+    if (!file_.is_open()) {
+        std::cout << "[USB] Failed to open block device image " << path << std::endl;
+    }
+}
+
+bool FileBlockDevice::readSectors(uint8_t* dst, uint32_t lba, uint32_t count) {
+    if (!file_.is_open() || lba + count > sectors_) return false;
+    readCommands++;
+    file_.seekg((std::streamoff)lba * sectorSize_);
+    file_.read((char*)dst, (std::streamsize)count * sectorSize_);
+    return (bool)file_;
+}
+
+bool FileBlockDevice::writeSectors(const uint8_t* src, uint32_t lba, uint32_t count) {
+    if (!file_.is_open() || lba + count > sectors_ || failWrites) return false;
+    writeCommands++;
+    file_.seekp((std::streamoff)lba * sectorSize_);
+    file_.write((const char*)src, (std::streamsize)count * sectorSize_);
+    file_.flush();
+    return (bool)file_;
+}
@@ -18,6 +18,7 @@ extern DesktopDisplay* g_display;
 #include "U8g2lib.h"
 #include "Buzzer.h"
 #include "USB.h"
+#include "file_block_device.h"
 
 SerialClass Serial;
 SD_MMCClass SD_MMC;
@@ -63,7 +64,8 @@ void oledLine(const String& text, bool /*clear*/) {
 }
 
 void refresh() {
-    if (g_display) g_display->einkRefresh();
+    // Mirrors einkFunc: one full-window present per refresh
+    display.display(false);
 }
 
 void drawThickLine(int x0, int y0, int x1, int y1, int thickness) {
@@ -118,8 +120,14 @@ int digitalPinToInterrupt(uint8_t pin) {
 }
 
 
-// Only USB_INIT is missing from real PocketMage source
+// Only USB_INIT is missing from real PocketMage source.
+// There is no USB host here; mscCache runs against a disk image instead of the
+// card (tests/msc_cache_check.cpp checks its transfers).
+static FileBlockDevice* usbBlocks = nullptr;
+
 void USB_INIT() {
+    if (!usbBlocks) usbBlocks = new FileBlockDevice("./data/usb_disk.img", 65536);
+    if (usbBlocks->isOpen()) mscCache.begin(usbBlocks);
     std::cout << "[USB] App initialized" << std::endl;
 }
 
@@ -174,6 +182,10 @@ File::File(const std::string& path, const std::string& mode) : inFile(nullptr),
             } else if (mode == "a" || mode == FILE_APPEND) {
                 outFile = std::make_unique<std::ofstream>(fullPath, std::ios::app);
                 isOpen = outFile->is_open();
+            } else if (mode == "r+") {
+                // Update in place: existing file, no truncation
+                outFile = std::make_unique<std::ofstream>(fullPath, std::ios::in | std::ios::out);
+                isOpen = outFile->is_open();
             }
         }
     } catch (...) {
@@ -250,6 +262,12 @@ int File::read() {
     return inFile->get();
 }
 
+size_t File::read(uint8_t* buf, size_t len) {
+    if (!inFile || !inFile->is_open() || !buf) return 0;
+    inFile->read(reinterpret_cast<char*>(buf), len);
+    return inFile->gcount();
+}
+
 String File::readString() {
     if (!inFile || !inFile->is_open()) return String("");
     std::string result((std::istreambuf_iterator<char>(*inFile)), std::istreambuf_iterator<char>());
@@ -269,12 +287,16 @@ bool File::available() {
 }
 
 void File::seek(size_t pos) {
-    if (inFile && inFile->is_open()) inFile->seekg(pos);
+    if (inFile && inFile->is_open()) {
+        inFile->clear();  // a read that hit EOF leaves failbit set
+        inFile->seekg(pos);
+    }
     if (outFile && outFile->is_open()) outFile->seekp(pos);
 }
 
 size_t File::size() {
     if (!inFile || !inFile->is_open()) return 0;
+    inFile->clear();
     auto current = inFile->tellg();
     inFile->seekg(0, std::ios::end);
     auto size = inFile->tellg();
@@ -282,6 +304,13 @@ size_t File::size() {
     return size;
 }
 
+time_t File::getLastWrite() {
+    std::error_code ec;
+    auto t = std::filesystem::last_write_time("./data/" + filePath, ec);
+    if (ec) return 0;
+    return (time_t)std::chrono::duration_cast<std::chrono::seconds>(t.time_since_epoch()).count();
+}
+
 bool File::isDirectory() {
     return isDir;
 }
@@ -290,9 +319,10 @@ File File::openNextFile() {
     if (!isDir) return File();
     if (dirIndex >= dirEntries.size()) return File();
     std::string child = dirEntries[dirIndex++];
-    // Open child as a file (read mode)
-    // Convert full path back to relative path under ./data/
-    std::string rel = child;
+    // Open child as a file (read mode), relative to this directory
+    std::string rel = filePath;
+    if (rel.empty() || rel.back() != '/') rel += "/";
+    rel += child;
     const std::string prefix = "./data/";
     if (rel.rfind(prefix, 0) == 0) rel = rel.substr(prefix.size());
     // If the child is a directory, return a File representing that directory
@@ -370,32 +400,21 @@ String utf8SafeBackspace(const String& text) {
 bool loadKeyboardLayout(const String& layoutName) {
     std::cout << "[UTF8] loadKeyboardLayout() called with: " << layoutName.c_str() << std::endl;
     
-    // Manually populate DeadTable for emulator since JSON loading isn't working
-    DeadTable.clear();
-    
-    // Apostrophe (') dead key combinations
-    DeadTable.push_back({"'", "a", "á"});
-    DeadTable.push_back({"'", "e", "é"});
-    DeadTable.push_back({"'", "i", "í"});
-    DeadTable.push_back({"'", "o", "ó"});
-    DeadTable.push_back({"'", "u", "ú"});
-    DeadTable.push_back({"'", "y", "ý"});
-    DeadTable.push_back({"'", "A", "Á"});
-    DeadTable.push_back({"'", "E", "É"});
-    DeadTable.push_back({"'", "I", "Í"});
-    DeadTable.push_back({"'", "O", "Ó"});
-    DeadTable.push_back({"'", "U", "Ú"});
-    DeadTable.push_back({"'", "Y", "Ý"});
-    DeadTable.push_back({"'", "c", "ć"});
-    DeadTable.push_back({"'", "C", "Ć"});
-    DeadTable.push_back({"'", "n", "ń"});
-    DeadTable.push_back({"'", "N", "Ń"});
-    DeadTable.push_back({"'", "s", "ś"});
-    DeadTable.push_back({"'", "S", "Ś"});
-    DeadTable.push_back({"'", "z", "ź"});
-    DeadTable.push_back({"'", "Z", "Ź"});
-    
-    std::cout << "[UTF8] Populated DeadTable with " << DeadTable.size() << " rules" << std::endl;
+    // Compile the apostrophe dead key rules for the emulator, which maps
+    // its keys directly rather than through the JSON layouts
+    static const char* const rules[][2] = {
+        {"a", "á"}, {"e", "é"}, {"i", "í"}, {"o", "ó"}, {"u", "ú"}, {"y", "ý"},
+        {"A", "Á"}, {"E", "É"}, {"I", "Í"}, {"O", "Ó"}, {"U", "Ú"}, {"Y", "Ý"},
+        {"c", "ć"}, {"C", "Ć"}, {"n", "ń"}, {"N", "Ń"}, {"s", "ś"}, {"S", "Ś"},
+        {"z", "ź"}, {"Z", "Ź"},
+    };
+    KeyLayoutBuilder builder;
+    builder.setName(layoutName);
+    for (const auto& r : rules) builder.addDead("'", r[0], r[1]);
+    std::vector<uint8_t> blob = builder.build(0, 0);
+    if (!ActiveLayout.adopt(blob)) return false;
+
+    std::cout << "[UTF8] Compiled " << (sizeof(rules) / sizeof(rules[0])) << " dead key rules" << std::endl;
     
     return true;
 }
@@ -678,7 +697,11 @@ void oledScroll() {
 }
 
 void setTXTFont(const GFXfont* font) {
-    // Mock font setting function
+    // Same row math as getMaxLines() on the device, with the emulator's fixed
+    // 16px text rows standing in for the font's glyph height
+    currentFont = (GFXfont*)font;
+    fontHeight = 16 - lineSpacing;
+    maxLines = (display.height() - 26) / (fontHeight + lineSpacing);
 }
 
 void vTaskDelete(void* handle) {
@@ -703,6 +726,7 @@ void einkHandler(void* parameter) {
 }
 
 void processKB_USB() {
+    mscCache.idle();
     // Mock USB keyboard processing
     std::cout << "[USB] Processing keyboard input" << std::endl;
 }
@@ -717,7 +741,7 @@ void einkTextDynamic(bool refresh, bool clear) {
     
     if (g_display) {
         if (clear) {
-            g_display->einkClear();
+            g_display->einkFill(false);
         }
         
         // Render text from allLines vector and currentLine
@@ -740,20 +764,40 @@ void einkTextDynamic(bool refresh, bool clear) {
             y += lineHeight;
         }
         
-        // Render current line being typed
-        if (currentLine.length() > 0 && y < 100) {
+        // Render current line being typed (TXT keeps it inside allLines)
+        if (CurrentAppState != TXT && currentLine.length() > 0 && y < 100) {
             std::cout << "[EinkTextDynamic] Drawing current line: '" << currentLine << "'" << std::endl;
             g_display->einkDrawText(currentLine.c_str(), 5, y, 12);
         }
     }
 }
 
+void einkTextLine(long line) {
+    std::cout << "[EinkTextLine] line=" << line << std::endl;
+    einkTextDynamic(true, true);
+    if (g_display) g_display->einkPartialRefresh();
+}
+
+void einkTextView() {
+    std::cout << "[EinkTextView] top=" << txtView.topLine() << std::endl;
+    if (!g_display) return;
+    g_display->einkFill(false);
+
+    std::vector<String> rows;
+    txtView.visibleRows(rows, maxLines);
+    int y = 20;
+    for (const String& row : rows) {
+        if (row.length() > 0) g_display->einkDrawText(row.c_str(), 5, y, 12);
+        y += fontHeight + lineSpacing;
+    }
+}
+
 void einkTextPartial(String text, bool clear) {
     std::cout << "[EinkTextPartial] text='" << text.c_str() << "' clear=" << clear << std::endl;
     
     if (g_display) {
         if (clear) {
-            g_display->einkClear();
+            g_display->einkFill(false);
         }
         
         // Simple text rendering - split by lines and render each line
@@ -785,11 +829,35 @@ void multiPassRefesh(int passes) {
     std::cout << "[MultiPass] passes=" << passes << std::endl;
 }
 
-void listDir(SD_MMCClass& fs, const char* dirname) {
-    std::cout << "[ListDir] " << dirname << std::endl;
+void listDir() {
+    std::cout << "[ListDir] page " << filesPage << std::endl;
+    size_t pages = sdIndex.pageCount(MAX_FILES);
+    filesPageCount = pages;
+    if (filesPage >= pages) filesPage = pages - 1;
+    sdIndex.fillPage(filesPage, filesList, MAX_FILES);
+}
+
+void prefetchDirIndex() {
+    sdIndex.warm();
+}
+
+void filesPageStep(int delta) {
+    long page = (long)filesPage + delta;
+    if (page < 0) page = 0;
+    if (page >= (long)sdIndex.pageCount(MAX_FILES)) page = sdIndex.pageCount(MAX_FILES) - 1;
+    filesPage = page;
+}
+
+void filesCycleSort() {
+    sdIndex.setSort((DirSort)((sdIndex.sortKey() + 1) % 3));
+    filesPage = 0;
 }
 
-void oledLine(String text, bool center, String prefix) {
+void oledLine(String text, bool center, String prefix, int cursorPos) {
+    // Show the editor caret, the device draws it as a bar under the text
+    if (cursorPos >= 0 && cursorPos <= (int)text.length()) {
+        text = text.substring(0, cursorPos) + "|" + text.substring(cursorPos);
+    }
     String fullText = prefix + ": " + text;
     oled_set_lines(fullText.c_str(), "", "");
 }
@@ -798,6 +866,10 @@ void oledWord(String text, bool center, bool newline) {
     oled_set_lines(text.c_str(), "", "");
 }
 
+void oledPresent() {
+    u8g2.sendBuffer();
+}
+
 void statusBar(String text, bool refresh) {
     oled_set_lines("", "", text.c_str());
 }
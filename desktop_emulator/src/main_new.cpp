@@ -1,6 +1,7 @@
 #include "pocketmage_compat.h"
 #include "desktop_display_sdl2.h"
 #include "oled_service.h"
+#include "RenderQueue.h"
 #include <iostream>
 #include <csignal>
 #include <cstdlib>
@@ -54,7 +55,7 @@ void emulatorSetup() {
     }
     
     // Initialize PocketMage state variables first
-    extern volatile bool newState;
+    extern RenderFlag newState;
     extern AppState CurrentAppState;
     newState = true;
     CurrentAppState = HOME;
@@ -82,7 +83,7 @@ void emulatorSetup() {
     
     std::cout << "Calling PocketMage HOME handler..." << std::endl;
     applicationEinkHandler();
-    g_display->present();
+    g_display->present();  // once, in case the handler drew without a refresh
     std::cout << "Initial drawing complete." << std::endl;
 
     // Show PocketMage on the small OLED at startup
@@ -97,7 +98,7 @@ void emulatorLoop() {
     
     // Force HOME screen redraw every 60 frames to show icons
     if (frameCount % 60 == 0) {
-        extern volatile bool newState;
+        extern RenderFlag newState;
         newState = true;
     }
     
@@ -109,12 +110,10 @@ void emulatorLoop() {
     // Call real PocketMage loop to process input
     loop();
     
-    // Call the E-Ink handler to render UI
+    // Call the E-Ink handler to render UI; its display()/refresh() calls
+    // put the panel on screen, like the device
     applicationEinkHandler();
     
-    // Present only after all rendering is complete
-    g_display->present();
-    
     // Limit frame rate
     delay(33); // ~30 FPS
 }
@@ -137,15 +136,13 @@ int main() {
         // Call real PocketMage loop to process input
         loop();
         
-        // Call the E-Ink handler to render UI
+        // Call the E-Ink handler to render UI; its display()/refresh() calls
+        // put the panel on screen, like the device
         applicationEinkHandler();
         
         // Present OLED updates once (main thread)
         oled_present_if_dirty();
         
-        // Present only after all rendering is complete
-        g_display->present();
-        
         frameCount++;
         if (frameCount % 100 == 0) {
             std::cout << "[MAIN] Frame " << frameCount << std::endl;
@@ -29,20 +29,8 @@ int countLines(String input, size_t maxLineLength) {
 }
 
 void stringToVector(String inputText) {
-    allLines.clear();
-    String line = "";
-    for (int i = 0; i < inputText.length(); ++i) {
-        char c = inputText[i];
-        if (c == '\r') continue;
-        if (c == '\n') {
-            allLines.push_back(line);
-            line = "";
-        } else {
-            line += c;
-        }
-    }
-    if (line.length() > 0) {
-        allLines.push_back(line);
-    }
+    txtDoc.load(inputText);
+    txtCursor = txtDoc.length();
+    txtLayout();
     newLineAdded = true;
 }
@@ -0,0 +1,89 @@
+// MscCache transfer check, run by ctest. Needs the emulator runtime only for
+// millis()/delay() and the globals MscCache.cpp pulls in.
+#include "file_block_device.h"
+#include "globals.h"
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+static bool report(const char* what, bool ok, uint32_t got, uint32_t want) {
+    std::cout << "[USB] MscCache " << what << ": " << got << " transfers (expected " << want << ") "
+              << (ok ? "OK" : "FAILED") << std::endl;
+    return ok;
+}
+
+// Drives a private MscCache over a scratch image: sequential reads, coalesced
+// writes, read-after-write and a failed deferred write, checking the data and
+// how many transfers reach the image.
+int main() {
+    const char* path = "msc_check.img";
+    const uint32_t secs = 256;
+    bool pass = true;
+    {
+        FileBlockDevice image(path, secs);
+        if (!image.isOpen()) return 1;
+        const uint32_t ss = image.sectorSize();
+
+        // Each sector holds its own number so misplaced data shows
+        std::vector<uint8_t> pattern(secs * ss);
+        for (uint32_t i = 0; i < pattern.size(); i++) pattern[i] = (uint8_t)(i / ss);
+        image.writeSectors(pattern.data(), 0, secs);
+        image.readCommands = image.writeCommands = 0;
+
+        MscCache cache;
+        cache.begin(&image);
+        std::vector<uint8_t> buf(ss);
+
+        // Sequential single-sector reads: one direct read, then one per window
+        const uint32_t reads = 2 * MSC_READ_AHEAD_SECTORS;
+        bool dataOk = true;
+        for (uint32_t lba = 0; lba < reads; lba++) {
+            dataOk &= cache.read(lba, buf.data(), ss) == (int32_t)ss && buf[0] == (uint8_t)lba;
+        }
+        uint32_t want = 1 + (reads - 1 + MSC_READ_AHEAD_SECTORS - 1) / MSC_READ_AHEAD_SECTORS;
+        pass &= report("sequential reads", dataOk && image.readCommands == want, image.readCommands, want);
+
+        // Contiguous single-sector writes go out a full buffer at a time
+        const uint32_t writes = 2 * MSC_WRITE_COALESCE_SECTORS;
+        image.writeCommands = 0;
+        for (uint32_t lba = 100; lba < 100 + writes; lba++) {
+            std::fill(buf.begin(), buf.end(), 0xA5);
+            cache.write(lba, buf.data(), ss);
+        }
+        cache.flush();
+        want = writes / MSC_WRITE_COALESCE_SECTORS;
+        pass &= report("coalesced writes", image.writeCommands == want, image.writeCommands, want);
+
+        // Reading sectors that are still buffered writes them out first
+        image.writeCommands = 0;
+        for (uint32_t lba = 200; lba < 204; lba++) {
+            std::fill(buf.begin(), buf.end(), 0x5A);
+            cache.write(lba, buf.data(), ss);
+        }
+        uint32_t beforeRead = image.writeCommands;
+        std::fill(buf.begin(), buf.end(), 0);
+        dataOk = cache.read(201, buf.data(), ss) == (int32_t)ss && buf[0] == 0x5A;
+        pass &= report("read-after-write", dataOk && beforeRead == 0 && image.writeCommands == 1, image.writeCommands, 1);
+
+        // A deferred write the card rejects is kept, the next request fails,
+        // and the data lands once the card recovers
+        image.writeCommands = 0;
+        std::fill(buf.begin(), buf.end(), 0x3C);
+        cache.write(10, buf.data(), ss);
+        image.failWrites = true;
+        delay(MSC_FLUSH_MS);
+        cache.idle();
+        bool reported = cache.read(50, buf.data(), ss) < 0;
+        image.failWrites = false;
+        bool retried = cache.flush();
+        std::fill(buf.begin(), buf.end(), 0);
+        dataOk = reported && retried && cache.read(10, buf.data(), ss) == (int32_t)ss && buf[0] == 0x3C;
+        pass &= report("failed deferred write", dataOk && image.writeCommands == 1, image.writeCommands, 1);
+
+        cache.end();
+    }
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    std::cout << "[USB] MscCache check " << (pass ? "passed" : "FAILED") << std::endl;
+    return pass ? 0 : 1;
+}